@@ -0,0 +1,99 @@
+#ifndef BRICKED_UP_APP_H
+#define BRICKED_UP_APP_H
+
+// The windowed game: screens, the App that owns the window and assets, and the drawing code.
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <stdbool.h>
+#include "sim.h"
+#include "replay.h"
+#include "frame_stats.h"
+#include "frame_pacer.h"
+#include "text.h"
+#include "sprite_batch.h"
+#include "render_layer.h"
+#include "asset_loader.h"
+#include "sim_thread.h"
+#include "netplay.h"
+#include "bot.h"
+
+#define POWERUP_ATLAS_CELL (POWERUP_SIZE + 2)
+#define REWIND_SECONDS 10
+#define REWIND_BUFFER_BYTES (64 * 1024 * 1024) // chaos games on big boards hold fewer seconds
+#define VERSUS_SEED 0x5EEDull // both peers have to start from the same one
+
+typedef enum {
+    SCREEN_TITLE,
+    SCREEN_GAMEPLAY,
+    SCREEN_GAMEOVER
+} GameScreen;
+
+typedef struct {
+    SDL_Window* window;
+    SDL_Renderer* renderer;
+    TTF_Font* font;
+    TextCache text;
+    SDL_Texture* spritesheet;
+    SpriteBatch sprites; // draws from spritesheet
+    SDL_Texture* powerup_atlas; // one pre-rendered icon per PowerUpType
+    SpriteBatch powerup_sprites;
+    ParticleSystem* particles; // attached to gs by start_game
+    JobPool* jobs; // attached to gs by start_game, for chaos games with many balls
+    SpriteBatch particle_quads; // untextured
+    RenderLayer background_layer; // borders and lives
+    int background_lives; // lives drawn into background_layer
+    RenderLayer brick_layer; // settled bricks
+    Uint64 brick_layer_settled[BITSET_WORDS(MAX_BRICKS)]; // which bricks brick_layer shows
+    int brick_layer_layout_id; // the bricks.layout_id of the board brick_layer shows
+    AssetLoader loader;
+    bool assets_ready; // font, spritesheet and level pack are in place; until then only the title shows
+    bool start_requested; // start a game as soon as the assets are ready
+    GameState gs; // owned by the simulation thread while a game runs
+    const GameState* view; // what gets drawn: the latest snapshot during a game, else &gs
+    SimThread* sim;
+    RewindBuffer* rewind; // held Backspace steps back through it; off while recording or playing a replay
+    float game_speed; // the debug speed asked for, handed to the simulation thread
+    LevelPack* level_pack; // NULL plays the built-in board
+    bool chaos; // start games in chaos mode
+    SimClock clock;
+    bool quit;
+    GameScreen current_screen;
+    bool debug_mode;
+    bool debug_render_collisions;
+    Uint64 show_speed_timer_ns;
+    Uint64 last_frame_ns; // when the last gameplay frame took its snapshot
+    Uint64 shown_steps; // steps the last drawn snapshot had run
+    const char* record_path; // record the next game started to this file
+    Replay* replay; // the game being recorded or played back, if any
+    bool playing_replay;
+    Uint64 unshown_input_ns; // timestamp of the oldest input not yet presented, 0 if none
+    FrameStats frame_stats;
+    FramePacer pacer;
+    int versus_player; // 0 or 1 when playing versus over the network, else -1
+    NetSocket* net_socket;
+    NetplaySession* netplay; // replaces the simulation thread during a versus game
+    Uint8 versus_input; // NETPLAY_INPUT_* held now, plus a launch waiting for the next frame
+    Uint64 versus_next_ns; // when the next netplay frame is due
+    bool bot_playing; // the bot plays every game, one after another, for soak tests
+    Bot bot;
+} App;
+
+void draw_filled_circle(SDL_Renderer* renderer, float center_x, float center_y, float radius);
+void draw_rounded_rect(SDL_Renderer* renderer, SDL_FRect* rect, float radius);
+// Everything that doesn't need the loaded assets, so the first frames can be drawn without them.
+bool render_init(App* app);
+// The rest, once app->spritesheet is set and app->text is prepared.
+bool render_attach_assets(App* app);
+void render_shutdown(App* app);
+void render_frame_stats(App* app);
+// Everything but the paddle and the balls resting on it, which render_paddle draws.
+void render_gameplay(App* app, float alpha);
+// Drawn last, just before presenting, so `paddle_x` can be latched as late as possible.
+void render_paddle(App* app, float alpha, float paddle_x);
+// Forces the cached layers to be redrawn, e.g. after the renderer lost its render targets.
+void render_invalidate_layers(App* app);
+void render_title_screen(App* app);
+void render_game_over_screen(App* app);
+
+#endif
@@ -0,0 +1,46 @@
+#include "asset_loader.h"
+#include "assets.h"
+#include <stdio.h>
+#include <string.h>
+
+static int load_assets(void* data) {
+    AssetLoader* loader = data;
+    loader->ok = false;
+
+    loader->font = assets_open_font(20);
+    if (loader->font == NULL) {
+        printf("Failed to load font: %s\n", SDL_GetError());
+    } else if (text_cache_prepare(&loader->text, loader->font)) {
+        loader->ok = true;
+    }
+    if (loader->ok && loader->levels_path != NULL) {
+        loader->level_pack = level_pack_open(loader->levels_path);
+        loader->ok = loader->level_pack != NULL;
+    }
+
+    SDL_SetAtomicInt(&loader->done, 1);
+    return 0;
+}
+
+bool asset_loader_start(AssetLoader* loader, const char* levels_path) {
+    memset(loader, 0, sizeof(AssetLoader));
+    loader->levels_path = levels_path;
+    loader->thread = SDL_CreateThread(load_assets, "asset loader", loader);
+    if (loader->thread == NULL) {
+        printf("Failed to start asset loader: %s\n", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+bool asset_loader_done(AssetLoader* loader) {
+    return SDL_GetAtomicInt(&loader->done) != 0;
+}
+
+bool asset_loader_join(AssetLoader* loader) {
+    if (loader->thread != NULL) {
+        SDL_WaitThread(loader->thread, NULL);
+        loader->thread = NULL;
+    }
+    return loader->ok;
+}
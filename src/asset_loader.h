@@ -0,0 +1,35 @@
+#ifndef BRICKED_UP_ASSET_LOADER_H
+#define BRICKED_UP_ASSET_LOADER_H
+
+// Loads the game's assets on a background thread while the main thread is already showing
+// frames. The thread does everything that doesn't need the renderer: opening the font,
+// rasterizing the glyph atlas and mapping the level pack. What it produces stays in the
+// loader until the main thread, which owns the renderer, takes it and uploads the textures.
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <stdbool.h>
+#include "level_pack.h"
+#include "text.h"
+
+typedef struct {
+    SDL_Thread* thread;
+    SDL_AtomicInt done;
+    const char* levels_path; // NULL plays the built-in board
+    bool ok;
+    // Valid once the loader is done, until the main thread takes them
+    TTF_Font* font;
+    TextCache text; // prepared; needs text_cache_upload
+    LevelPack* level_pack;
+} AssetLoader;
+
+bool asset_loader_start(AssetLoader* loader, const char* levels_path);
+
+// Whether the thread has finished; never blocks.
+bool asset_loader_done(AssetLoader* loader);
+
+// Waits for the thread to finish. Returns false, with a message printed, if anything failed
+// to load; whatever did load is still left in the loader.
+bool asset_loader_join(AssetLoader* loader);
+
+#endif
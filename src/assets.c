@@ -0,0 +1,26 @@
+#include "assets.h"
+
+// Defined in the assets_data.c that bricked_up_assets generates at build time
+extern const size_t asset_font_size;
+extern const Uint8 asset_font[];
+extern const int asset_spritesheet_width;
+extern const int asset_spritesheet_height;
+extern const Uint8 asset_spritesheet[]; // RGBA32, rows packed
+
+TTF_Font* assets_open_font(float size) {
+    SDL_IOStream* io = SDL_IOFromConstMem(asset_font, asset_font_size);
+    if (io == NULL) return NULL;
+    return TTF_OpenFontIO(io, true, size);
+}
+
+SDL_Texture* assets_load_spritesheet(SDL_Renderer* renderer) {
+    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+        asset_spritesheet_width, asset_spritesheet_height);
+    if (texture == NULL) return NULL;
+    if (!SDL_UpdateTexture(texture, NULL, asset_spritesheet, asset_spritesheet_width * 4)) {
+        SDL_DestroyTexture(texture);
+        return NULL;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    return texture;
+}
@@ -0,0 +1,15 @@
+#ifndef BRICKED_UP_ASSETS_H
+#define BRICKED_UP_ASSETS_H
+
+// The game's font and spritesheet, compiled into the executable by bricked_up_assets.
+// Loading them touches no files, so the game starts the same from any working directory.
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+
+TTF_Font* assets_open_font(float size);
+
+// The spritesheet, uploaded straight from its pre-decoded RGBA pixels.
+SDL_Texture* assets_load_spritesheet(SDL_Renderer* renderer);
+
+#endif
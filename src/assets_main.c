@@ -0,0 +1,90 @@
+// Asset packer: writes the font and the spritesheet, decoded to RGBA, as a C source file
+// compiled into the game, so startup neither reads nor decodes anything.
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void write_bytes(FILE* out, const char* name, const Uint8* data, size_t size) {
+    fprintf(out, "const Uint8 %s[] = {\n", name);
+    for (size_t i = 0; i < size; i++) {
+        fprintf(out, "%u,%s", data[i], i % 32 == 31 || i + 1 == size ? "\n" : "");
+    }
+    fprintf(out, "};\n");
+}
+
+static Uint8* read_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    Uint8* data = NULL;
+    long length = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    if (length > 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = malloc((size_t)length);
+        if (data != NULL && fread(data, 1, (size_t)length, file) != (size_t)length) {
+            free(data);
+            data = NULL;
+        }
+    }
+    fclose(file);
+    *size = data != NULL ? (size_t)length : 0;
+    return data;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        printf("Usage: %s OUT FONT SPRITESHEET\n", argv[0]);
+        return 1;
+    }
+
+    size_t font_size;
+    Uint8* font = read_file(argv[2], &font_size);
+    if (font == NULL) {
+        printf("Failed to read font: %s\n", argv[2]);
+        return 1;
+    }
+
+    SDL_Surface* loaded = IMG_Load(argv[3]);
+    SDL_Surface* sheet = loaded != NULL ? SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32) : NULL;
+    if (sheet == NULL) {
+        printf("Failed to decode spritesheet: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    // Rows are written without the surface's pitch padding
+    size_t row_size = (size_t)sheet->w * 4;
+    Uint8* pixels = malloc(row_size * sheet->h);
+    if (pixels == NULL) {
+        printf("Failed to allocate spritesheet\n");
+        return 1;
+    }
+    for (int y = 0; y < sheet->h; y++) {
+        memcpy(pixels + y * row_size, (const Uint8*)sheet->pixels + (size_t)y * sheet->pitch, row_size);
+    }
+
+    FILE* out = fopen(argv[1], "w");
+    if (out == NULL) {
+        printf("Failed to write assets: %s\n", argv[1]);
+        return 1;
+    }
+    fprintf(out, "// Generated by bricked_up_assets from %s and %s; do not edit.\n", argv[2], argv[3]);
+    fprintf(out, "#include <SDL3/SDL.h>\n\n");
+    fprintf(out, "const size_t asset_font_size = %zu;\n", font_size);
+    write_bytes(out, "asset_font", font, font_size);
+    fprintf(out, "const int asset_spritesheet_width = %d;\n", sheet->w);
+    fprintf(out, "const int asset_spritesheet_height = %d;\n", sheet->h);
+    write_bytes(out, "asset_spritesheet", pixels, row_size * sheet->h);
+    bool ok = !ferror(out);
+    if (fclose(out) != 0) ok = false;
+    if (!ok) {
+        printf("Failed to write assets: %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("Packed %zu bytes of font and a %dx%d spritesheet into %s\n", font_size, sheet->w, sheet->h, argv[1]);
+    free(pixels);
+    free(font);
+    SDL_DestroySurface(sheet);
+    SDL_DestroySurface(loaded);
+    return 0;
+}
@@ -0,0 +1,698 @@
+// Microbenchmarks for the hot paths: swept_aabb, the brick sweep, whole update_gameplay
+// steps, the bot, the particle update and render_gameplay into an offscreen software renderer. Each benchmark runs a
+// number of samples and reports the min, median and p99 time per operation, on stdout
+// and optionally as JSON so runs from different commits can be compared.
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "app.h"
+#include "assets.h"
+#include "netplay.h"
+#include "bot.h"
+
+#define BENCH_MAX_RESULTS 96
+#define BENCH_MANY_BALLS 64 // for the brick sweep, which doesn't go through the ball array
+#define BENCH_STEPS_PER_SAMPLE 60
+#define BENCH_FRAME_NS (SDL_NS_PER_SECOND / 60)
+
+typedef enum {
+    BOARD_FULL,
+    BOARD_HALF,
+    BOARD_NEARLY_EMPTY,
+    BOARD_ENORMOUS, // a full board of the largest size a level pack allows
+    BOARD_ENORMOUS_NEARLY_EMPTY,
+    BOARD_COUNT
+} BoardFill;
+
+static const char* board_names[BOARD_COUNT] = { "full", "half", "nearly_empty", "enormous", "enormous_nearly_empty" };
+
+typedef struct {
+    char name[64];
+    const char* unit;
+    int samples;
+    Uint64 ops_per_sample;
+    double min_ns;
+    double median_ns;
+    double p99_ns;
+} BenchResult;
+
+typedef struct {
+    int samples;
+    const char* filter;
+    BenchResult results[BENCH_MAX_RESULTS];
+    int result_count;
+    double* sample_ns; // per-op time of each sample of the benchmark being run
+} Bench;
+
+typedef struct {
+    Uint64 now_ns;
+} VirtualClock;
+
+static Uint64 virtual_clock_now(void* userdata) {
+    return ((VirtualClock*)userdata)->now_ns;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static bool bench_wanted(const Bench* bench, const char* name) {
+    return bench->filter == NULL || strstr(name, bench->filter) != NULL;
+}
+
+// Sorts the samples of the benchmark just run and files its result.
+static void bench_report(Bench* bench, const char* name, const char* unit, Uint64 ops_per_sample) {
+    if (bench->result_count == BENCH_MAX_RESULTS) return;
+
+    BenchResult* result = &bench->results[bench->result_count++];
+    int p99_index = (int)(bench->samples * 0.99);
+    if (p99_index > bench->samples - 1) p99_index = bench->samples - 1;
+
+    qsort(bench->sample_ns, bench->samples, sizeof(double), compare_doubles);
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->unit = unit;
+    result->samples = bench->samples;
+    result->ops_per_sample = ops_per_sample;
+    result->min_ns = bench->sample_ns[0];
+    result->median_ns = bench->sample_ns[bench->samples / 2];
+    result->p99_ns = bench->sample_ns[p99_index];
+    printf("%-40s %12.1f %12.1f %12.1f  ns/%s\n", result->name, result->min_ns, result->median_ns, result->p99_ns, unit);
+}
+
+// A one-level pack holding a generated MAX_BRICK_ROWS x MAX_BRICK_COLS board
+static const LevelPack* enormous_pack(void) {
+    static Uint8 cells[MAX_BRICKS];
+    static BrickType types[BRICK_SPRITE_ROWS];
+    static Level level;
+    static LevelPack pack;
+    if (pack.level_count == 0) {
+        level_generate(&level, cells, types, MAX_BRICK_ROWS, MAX_BRICK_COLS, 0);
+        pack.level_count = 1;
+        pack.levels = &level;
+    }
+    return &pack;
+}
+
+// A game with `balls` balls in flight over a board cleared down to `fill`. Lives are
+// raised so a sample never ends in a game over.
+static void setup_game(GameState* gs, BoardFill fill, int balls, float game_speed) {
+    bool enormous = fill == BOARD_ENORMOUS || fill == BOARD_ENORMOUS_NEARLY_EMPTY;
+    sim_start_game(gs, 1, enormous ? enormous_pack() : NULL);
+    gs->lives = 1000;
+    gs->game_speed = game_speed;
+
+    for (int i = 0; i < gs->bricks.count; i++) {
+        if (fill == BOARD_HALF && i % 2 == 1) brick_remove(&gs->bricks, i);
+        if ((fill == BOARD_NEARLY_EMPTY || fill == BOARD_ENORMOUS_NEARLY_EMPTY) && i % 20 != 7) brick_remove(&gs->bricks, i);
+    }
+
+    gs->ball_launched = true;
+    gs->chaos = balls > BALL_LIMIT;
+    for (int i = 0; i < balls && i < MAX_BALLS; i++) {
+        Ball* ball = &gs->balls[i];
+        float angle = (0.15f + 0.7f * sim_randf(gs)) * (float)M_PI;
+        ball->active = true;
+        ball->is_stuck = false;
+        ball->rect.x = BORDER_THICKNESS + sim_randf(gs) * (SCREEN_WIDTH - 2 * BORDER_THICKNESS - BALL_SIZE);
+        ball->rect.y = SCREEN_HEIGHT / 2 + sim_randf(gs) * (SCREEN_HEIGHT / 4);
+        ball->rect.w = BALL_SIZE;
+        ball->rect.h = BALL_SIZE;
+        ball->vel_x = BALL_SPEED * cosf(angle);
+        ball->vel_y = -BALL_SPEED * sinf(angle);
+        gs->ball_count = i + 1;
+    }
+    store_previous_state(gs);
+}
+
+static void bench_swept_aabb(Bench* bench) {
+    const char* name = "swept_aabb";
+    const int count = 1024;
+    const int rounds = 16;
+    if (!bench_wanted(bench, name)) return;
+
+    GameState* gs = malloc(sizeof(GameState));
+    SDL_FRect* boxes = malloc(sizeof(SDL_FRect) * count);
+    SDL_FPoint* vels = malloc(sizeof(SDL_FPoint) * count);
+    volatile float sink = 0.0f;
+
+    sim_start_game(gs, 2, NULL);
+    for (int i = 0; i < count; i++) {
+        boxes[i].x = sim_randf(gs) * SCREEN_WIDTH;
+        boxes[i].y = sim_randf(gs) * SCREEN_HEIGHT;
+        boxes[i].w = BALL_SIZE;
+        boxes[i].h = BALL_SIZE;
+        vels[i].x = (sim_randf(gs) - 0.5f) * 2.0f * BALL_SPEED * SIM_STEP_NS / 1e9f * 10.0f;
+        vels[i].y = (sim_randf(gs) - 0.5f) * 2.0f * BALL_SPEED * SIM_STEP_NS / 1e9f * 10.0f;
+    }
+    SDL_FRect brick = brick_rect(&gs->bricks, gs->bricks.count / 2);
+
+    for (int s = 0; s < bench->samples; s++) {
+        Uint64 start_ns = SDL_GetTicksNS();
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < count; i++) {
+                float nx, ny;
+                sink += swept_aabb(boxes[i], vels[i], brick, &nx, &ny);
+            }
+        }
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns) / (count * rounds);
+    }
+    bench_report(bench, name, "call", (Uint64)count * rounds);
+
+    free(vels);
+    free(boxes);
+    free(gs);
+}
+
+// The broadphase query plus batch kernel that update_gameplay runs once per ball substep.
+static void bench_sweep_bricks(Bench* bench, BoardFill fill, int balls) {
+    char name[64];
+    const int rounds = 64;
+    snprintf(name, sizeof(name), "sweep_bricks/%s/%d_balls", board_names[fill], balls);
+    if (!bench_wanted(bench, name)) return;
+
+    GameState* gs = malloc(sizeof(GameState));
+    SDL_FRect* boxes = malloc(sizeof(SDL_FRect) * balls);
+    SDL_FPoint* vels = malloc(sizeof(SDL_FPoint) * balls);
+    volatile int sink = 0;
+
+    setup_game(gs, fill, 0, 1.0f);
+    // Spread the balls over the brick area, where the sweep has the most work
+    for (int i = 0; i < balls; i++) {
+        float angle = sim_randf(gs) * 2.0f * (float)M_PI;
+        boxes[i].x = gs->brick_grid.origin_x + sim_randf(gs) * gs->brick_grid.cols * gs->brick_grid.cell_w;
+        boxes[i].y = gs->brick_grid.origin_y + sim_randf(gs) * (gs->brick_grid.rows + 2) * gs->brick_grid.cell_h;
+        boxes[i].w = BALL_SIZE;
+        boxes[i].h = BALL_SIZE;
+        vels[i].x = BALL_SPEED * cosf(angle);
+        vels[i].y = BALL_SPEED * sinf(angle);
+    }
+
+    for (int s = 0; s < bench->samples; s++) {
+        Uint64 start_ns = SDL_GetTicksNS();
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < balls; i++) {
+                int hit_bricks[MAX_SIMULTANEOUS_HITS];
+                float time = (float)SIM_STEP_NS / SDL_NS_PER_SECOND;
+                float nx = 0.0f, ny = 0.0f;
+                sink += sweep_bricks(&gs->bricks, &gs->brick_grid, boxes[i], vels[i], &time, &nx, &ny, hit_bricks);
+            }
+        }
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns) / (rounds * balls);
+    }
+    bench_report(bench, name, "ball", (Uint64)rounds * balls);
+
+    free(vels);
+    free(boxes);
+    free(gs);
+}
+
+// Whole fixed steps. Every sample restarts from the same state so the scenario doesn't drift.
+// With `jobs`, ball counts past SIM_CHUNK_BALLS move in chunks spread over the pool.
+static void bench_update(Bench* bench, BoardFill fill, int balls, JobPool* jobs) {
+    char name[64];
+    snprintf(name, sizeof(name), "update_gameplay/%s/%d_balls%s", board_names[fill], balls, jobs != NULL ? "/jobs" : "");
+    if (!bench_wanted(bench, name)) return;
+
+    GameState* start = malloc(sizeof(GameState));
+    GameState* gs = malloc(sizeof(GameState));
+    setup_game(start, fill, balls, 1.0f);
+    start->jobs = jobs;
+
+    for (int s = 0; s < bench->samples; s++) {
+        memcpy(gs, start, sizeof(GameState));
+        Uint64 start_ns = SDL_GetTicksNS();
+        for (int i = 0; i < BENCH_STEPS_PER_SAMPLE; i++) {
+            store_previous_state(gs);
+            update_gameplay(gs, SIM_STEP_NS);
+        }
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns) / BENCH_STEPS_PER_SAMPLE;
+    }
+    bench_report(bench, name, "step", BENCH_STEPS_PER_SAMPLE);
+
+    free(gs);
+    free(start);
+}
+
+// A 60 Hz frame through advance_gameplay, which runs game_speed times as many steps.
+static void bench_advance(Bench* bench, BoardFill fill, int balls, float game_speed) {
+    char name[64];
+    const int frames = 30;
+    snprintf(name, sizeof(name), "advance_gameplay/%s/%d_balls/speed_%.0f", board_names[fill], balls, game_speed);
+    if (!bench_wanted(bench, name)) return;
+
+    GameState* start = malloc(sizeof(GameState));
+    GameState* gs = malloc(sizeof(GameState));
+    VirtualClock virtual_clock;
+    SimClock clock;
+    setup_game(start, fill, balls, game_speed);
+
+    for (int s = 0; s < bench->samples; s++) {
+        memcpy(gs, start, sizeof(GameState));
+        virtual_clock.now_ns = 0;
+        sim_clock_init(&clock, virtual_clock_now, &virtual_clock);
+        Uint64 start_ns = SDL_GetTicksNS();
+        for (int i = 0; i < frames; i++) {
+            virtual_clock.now_ns += BENCH_FRAME_NS;
+            advance_gameplay(gs, &clock);
+        }
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns) / frames;
+    }
+    bench_report(bench, name, "frame", frames);
+
+    free(gs);
+    free(start);
+}
+
+// Fills `ps` with `count` particles spread over the screen that outlive any benchmark.
+static void fill_particles(ParticleSystem* ps, int count) {
+    SDL_Color color = { 240, 200, 120, 255 };
+    particles_clear(ps);
+    for (int i = 0; i < count; i++) {
+        particles_spawn(ps, particles_randf(ps) * SCREEN_WIDTH, particles_randf(ps) * SCREEN_HEIGHT,
+            (particles_randf(ps) - 0.5f) * 0.01f, (particles_randf(ps) - 0.5f) * 0.01f, 1e9f, color);
+    }
+}
+
+// What the simulation thread copies out after each batch of steps, with the board already
+// laid out in the snapshot as it is from the second publish of a board on.
+static void bench_snapshot(Bench* bench, BoardFill fill, int balls, int particle_count) {
+    char name[64];
+    snprintf(name, sizeof(name), "snapshot/%s/%d_balls/%d", board_names[fill], balls, particle_count);
+    if (!bench_wanted(bench, name)) return;
+
+    GameState* gs = malloc(sizeof(GameState));
+    GameState* snapshot = malloc(sizeof(GameState));
+    ParticleSystem* ps = particles_create(PARTICLE_CAPACITY);
+    ParticleSystem* snapshot_ps = particles_create(PARTICLE_CAPACITY);
+    if (ps == NULL || snapshot_ps == NULL) {
+        particles_destroy(snapshot_ps);
+        particles_destroy(ps);
+        free(snapshot);
+        free(gs);
+        return;
+    }
+    setup_game(gs, fill, balls, 1.0f);
+    fill_particles(ps, particle_count);
+    snapshot->bricks.layout_id = 0;
+    sim_copy_render_state(snapshot, gs);
+
+    for (int s = 0; s < bench->samples; s++) {
+        Uint64 start_ns = SDL_GetTicksNS();
+        sim_copy_render_state(snapshot, gs);
+        particles_copy(snapshot_ps, ps);
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns);
+    }
+    bench_report(bench, name, "copy", 1);
+
+    particles_destroy(snapshot_ps);
+    particles_destroy(ps);
+    free(snapshot);
+    free(gs);
+}
+
+// A frame into the rewind buffer after every step, and a restore of the newest frame,
+// which decodes the longest chain of deltas the buffer keeps.
+static void bench_rewind(Bench* bench, BoardFill fill, int balls) {
+    char capture_name[64];
+    char restore_name[64];
+    snprintf(capture_name, sizeof(capture_name), "rewind_capture/%s/%d_balls", board_names[fill], balls);
+    snprintf(restore_name, sizeof(restore_name), "rewind_restore/%s/%d_balls", board_names[fill], balls);
+    if (!bench_wanted(bench, capture_name) && !bench_wanted(bench, restore_name)) return;
+
+    GameState* gs = malloc(sizeof(GameState));
+    RewindBuffer* rewind = rewind_create(256 * 1024 * 1024, bench->samples + REWIND_KEYFRAME_INTERVAL, REWIND_KEYFRAME_INTERVAL);
+    if (rewind == NULL) {
+        free(gs);
+        return;
+    }
+    setup_game(gs, fill, balls, 1.0f);
+    // Start from the end of a chain, so the samples cover its keyframe and deltas alike
+    for (int i = 0; i < REWIND_KEYFRAME_INTERVAL; i++) {
+        update_gameplay(gs, SIM_STEP_NS);
+        rewind_capture(rewind, gs);
+    }
+
+    for (int s = 0; s < bench->samples; s++) {
+        update_gameplay(gs, SIM_STEP_NS);
+        Uint64 start_ns = SDL_GetTicksNS();
+        rewind_capture(rewind, gs);
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns);
+    }
+    if (bench_wanted(bench, capture_name)) bench_report(bench, capture_name, "frame", 1);
+
+    // The frame before a keyframe, at the end of a full chain
+    int frame = rewind_count(rewind) - 1;
+    while (frame > 0 && frame % REWIND_KEYFRAME_INTERVAL != REWIND_KEYFRAME_INTERVAL - 1) frame--;
+    for (int s = 0; s < bench->samples; s++) {
+        Uint64 start_ns = SDL_GetTicksNS();
+        rewind_restore(rewind, frame, gs);
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns);
+    }
+    if (bench_wanted(bench, restore_name)) bench_report(bench, restore_name, "frame", 1);
+
+    rewind_destroy(rewind);
+    free(gs);
+}
+
+// The worst rollback netplay allows: both boards back NETPLAY_MAX_PREDICTION frames and
+// forward again. It has to fit well inside a frame.
+static void bench_netplay_rollback(Bench* bench, bool enormous) {
+    char name[64];
+    snprintf(name, sizeof(name), "netplay_rollback/%s/%d_frames", enormous ? "enormous" : "classic", NETPLAY_MAX_PREDICTION);
+    if (!bench_wanted(bench, name)) return;
+
+    NetplaySession* session = netplay_create(0, NULL, 1, enormous ? enormous_pack() : level_pack_builtin());
+    if (session == NULL) return;
+    netplay_advance(session, NETPLAY_INPUT_LAUNCH);
+    while (netplay_advance(session, NETPLAY_INPUT_LEFT)) {}
+
+    for (int s = 0; s < bench->samples; s++) {
+        Uint64 start_ns = SDL_GetTicksNS();
+        netplay_rollback(session, 0);
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns);
+    }
+    bench_report(bench, name, "rollback", 1);
+
+    netplay_destroy(session);
+}
+
+// What the bot spends deciding one frame, over a game it plays on, two steps a frame
+static void bench_bot_update(Bench* bench, BoardFill fill, int balls) {
+    char name[64];
+    snprintf(name, sizeof(name), "bot_update/%s/%d_balls", board_names[fill], balls);
+    if (!bench_wanted(bench, name)) return;
+
+    GameState* gs = malloc(sizeof(GameState));
+    Bot bot;
+    setup_game(gs, fill, balls, 1.0f);
+    bot_init(&bot);
+
+    for (int s = 0; s < bench->samples; s++) {
+        SimInput inputs[BOT_MAX_INPUTS];
+        Uint64 start_ns = SDL_GetTicksNS();
+        int count = bot_update(&bot, gs, inputs);
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns);
+        for (int i = 0; i < count; i++) {
+            sim_apply_input(gs, inputs[i]);
+        }
+        for (int i = 0; i < 2; i++) {
+            store_previous_state(gs);
+            update_gameplay(gs, SIM_STEP_NS);
+        }
+    }
+    bench_report(bench, name, "frame", 1);
+
+    free(gs);
+}
+
+// 60 Hz frames of a game the bot plays: bricks break, power-ups fall and the board changes,
+// as in a real game rather than a replayed opening
+static void bench_bot_play(Bench* bench, BoardFill fill) {
+    char name[64];
+    const int frames = 30;
+    snprintf(name, sizeof(name), "bot_play/%s", board_names[fill]);
+    if (!bench_wanted(bench, name)) return;
+
+    GameState* gs = malloc(sizeof(GameState));
+    VirtualClock virtual_clock = { 0 };
+    SimClock clock;
+    Bot bot;
+    setup_game(gs, fill, 1, 1.0f);
+    sim_clock_init(&clock, virtual_clock_now, &virtual_clock);
+    bot_init(&bot);
+
+    for (int s = 0; s < bench->samples; s++) {
+        Uint64 start_ns = SDL_GetTicksNS();
+        for (int f = 0; f < frames; f++) {
+            SimInput inputs[BOT_MAX_INPUTS];
+            int count = bot_update(&bot, gs, inputs);
+            for (int i = 0; i < count; i++) {
+                sim_apply_input(gs, inputs[i]);
+            }
+            virtual_clock.now_ns += BENCH_FRAME_NS;
+            advance_gameplay(gs, &clock);
+        }
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns) / frames;
+    }
+    bench_report(bench, name, "frame", frames);
+
+    free(gs);
+}
+
+static void bench_particles(Bench* bench, int count) {
+    char name[64];
+    const int rounds = 16;
+    snprintf(name, sizeof(name), "particles_update/%d", count);
+    if (!bench_wanted(bench, name)) return;
+
+    ParticleSystem* ps = particles_create(PARTICLE_CAPACITY);
+    if (ps == NULL) return;
+    fill_particles(ps, count);
+
+    for (int s = 0; s < bench->samples; s++) {
+        Uint64 start_ns = SDL_GetTicksNS();
+        for (int r = 0; r < rounds; r++) {
+            particles_update(ps, SIM_STEP_NS / 1000000.0f);
+        }
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns) / ((double)count * rounds);
+    }
+    bench_report(bench, name, "particle", (Uint64)count * rounds);
+
+    particles_destroy(ps);
+}
+
+static void bench_render(Bench* bench, App* app, BoardFill fill, int balls) {
+    char name[64];
+    const int frames = 4;
+    snprintf(name, sizeof(name), "render_gameplay/%s/%d_balls", board_names[fill], balls);
+    if (!bench_wanted(bench, name)) return;
+
+    setup_game(&app->gs, fill, balls, 1.0f);
+    particles_clear(app->particles);
+    app->gs.particles = app->particles;
+    for (int i = 0; i < 4; i++) {
+        update_gameplay(&app->gs, SIM_STEP_NS); // a few steps so particles and animations are live
+    }
+    app->gs.lives = 3; // the HUD draws one icon per life
+    for (int i = 0; i < MAX_POWERUPS; i++) {
+        PowerUp* powerup = &app->gs.powerups[i];
+        powerup->active = true;
+        powerup->type = i % POWERUP_TYPE_COUNT;
+        powerup->rect = (SDL_FRect){ 60.0f + i * 70.0f, 350.0f, POWERUP_SIZE, POWERUP_SIZE };
+        powerup->prev_y = powerup->rect.y;
+    }
+
+
+    for (int s = 0; s < bench->samples; s++) {
+        Uint64 start_ns = SDL_GetTicksNS();
+        for (int i = 0; i < frames; i++) {
+            render_gameplay(app, 0.5f);
+            render_paddle(app, 0.5f, sim_predict_paddle_x(&app->gs, &app->clock, 0.5f, SDL_GetTicksNS()));
+            SDL_RenderPresent(app->renderer);
+        }
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns) / frames;
+    }
+    bench_report(bench, name, "frame", frames);
+}
+
+// A full board with `count` particles on screen, for the cost of drawing them.
+static void bench_render_particles(Bench* bench, App* app, int count) {
+    char name[64];
+    const int frames = 4;
+    snprintf(name, sizeof(name), "render_particles/%d", count);
+    if (!bench_wanted(bench, name)) return;
+
+    setup_game(&app->gs, BOARD_FULL, 1, 1.0f);
+    app->gs.lives = 3;
+    app->gs.particles = app->particles;
+    fill_particles(app->particles, count);
+
+    for (int s = 0; s < bench->samples; s++) {
+        Uint64 start_ns = SDL_GetTicksNS();
+        for (int i = 0; i < frames; i++) {
+            render_gameplay(app, 0.5f);
+            render_paddle(app, 0.5f, sim_predict_paddle_x(&app->gs, &app->clock, 0.5f, SDL_GetTicksNS()));
+            SDL_RenderPresent(app->renderer);
+        }
+        bench->sample_ns[s] = (double)(SDL_GetTicksNS() - start_ns) / frames;
+    }
+    bench_report(bench, name, "frame", frames);
+}
+
+// Offscreen App: a software renderer drawing into a surface, with the game's own assets.
+static bool open_offscreen_app(App* app, SDL_Surface** target) {
+    memset(app, 0, sizeof(App));
+    *target = SDL_CreateSurface(SCREEN_WIDTH, SCREEN_HEIGHT, SDL_PIXELFORMAT_ARGB8888);
+    if (*target == NULL) {
+        printf("Skipping render benchmarks, no surface: %s\n", SDL_GetError());
+        return false;
+    }
+    app->renderer = SDL_CreateSoftwareRenderer(*target);
+    if (app->renderer == NULL) {
+        printf("Skipping render benchmarks, no software renderer: %s\n", SDL_GetError());
+        return false;
+    }
+    app->font = assets_open_font(20);
+    if (app->font == NULL) {
+        printf("Skipping render benchmarks, failed to load font: %s\n", SDL_GetError());
+        return false;
+    }
+    app->spritesheet = assets_load_spritesheet(app->renderer);
+    if (app->spritesheet == NULL) {
+        printf("Skipping render benchmarks, failed to load spritesheet: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureScaleMode(app->spritesheet, SDL_SCALEMODE_NEAREST);
+    if (!render_init(app) || !text_cache_prepare(&app->text, app->font) || !render_attach_assets(app)) {
+        printf("Skipping render benchmarks, failed to set up drawing\n");
+        return false;
+    }
+    app->current_screen = SCREEN_GAMEPLAY;
+    sim_clock_init(&app->clock, sim_wall_clock, NULL);
+    app->view = &app->gs; // drawn directly, with no simulation thread
+    return true;
+}
+
+static void close_offscreen_app(App* app, SDL_Surface* target) {
+    render_shutdown(app);
+    if (app->spritesheet != NULL) SDL_DestroyTexture(app->spritesheet);
+    if (app->font != NULL) TTF_CloseFont(app->font);
+    if (app->renderer != NULL) SDL_DestroyRenderer(app->renderer);
+    if (target != NULL) SDL_DestroySurface(target);
+}
+
+static bool write_json(const Bench* bench, const char* path, const char* label) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        printf("Failed to write %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"label\": \"%s\",\n", label);
+    fprintf(file, "  \"samples\": %d,\n", bench->samples);
+    fprintf(file, "  \"results\": [\n");
+    for (int i = 0; i < bench->result_count; i++) {
+        const BenchResult* result = &bench->results[i];
+        fprintf(file, "    { \"name\": \"%s\", \"unit\": \"ns/%s\", \"ops_per_sample\": %llu, \"min\": %.1f, \"median\": %.1f, \"p99\": %.1f }%s\n",
+            result->name, result->unit, (unsigned long long)result->ops_per_sample,
+            result->min_ns, result->median_ns, result->p99_ns, i + 1 < bench->result_count ? "," : "");
+    }
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+    fclose(file);
+    return true;
+}
+
+static void usage(const char* program) {
+    printf("Usage: %s [--samples N] [--filter TEXT] [--json FILE] [--label TEXT] [--no-render]\n", program);
+    printf("  --samples N    samples per benchmark (default 200)\n");
+    printf("  --filter TEXT  only run benchmarks whose name contains TEXT\n");
+    printf("  --json FILE    also write the results as JSON\n");
+    printf("  --label TEXT   stored in the JSON to tell runs apart, e.g. a commit hash\n");
+    printf("  --no-render    skip the render_gameplay benchmarks\n");
+}
+
+int main(int argc, char* argv[]) {
+    Bench bench = { 0 };
+    const char* json_path = NULL;
+    const char* label = "";
+    bool render = true;
+    const int ball_counts[] = { 1, BALL_LIMIT };
+    const int stress_ball_counts[] = { 256, 1024, MAX_BALLS }; // chaos mode
+    const int particle_counts[] = { 1000, 10000, 30000 };
+
+    bench.samples = 200;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            bench.samples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            bench.filter = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc) {
+            label = argv[++i];
+        } else if (strcmp(argv[i], "--no-render") == 0) {
+            render = false;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (bench.samples <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    bench.sample_ns = malloc(sizeof(double) * bench.samples);
+
+    printf("%-40s %12s %12s %12s\n", "benchmark", "min", "median", "p99");
+    bench_swept_aabb(&bench);
+    for (int fill = 0; fill < BOARD_COUNT; fill++) {
+        bench_sweep_bricks(&bench, fill, 1);
+        bench_sweep_bricks(&bench, fill, BALL_LIMIT);
+        bench_sweep_bricks(&bench, fill, BENCH_MANY_BALLS);
+    }
+    for (int fill = 0; fill < BOARD_COUNT; fill++) {
+        for (int i = 0; i < (int)SDL_arraysize(ball_counts); i++) {
+            bench_update(&bench, fill, ball_counts[i], NULL);
+        }
+    }
+    JobPool* jobs = job_pool_create(SDL_GetNumLogicalCPUCores() - 1);
+    for (int i = 0; i < (int)SDL_arraysize(stress_ball_counts); i++) {
+        bench_update(&bench, BOARD_FULL, stress_ball_counts[i], NULL);
+        bench_update(&bench, BOARD_FULL, stress_ball_counts[i], jobs);
+        bench_update(&bench, BOARD_ENORMOUS, stress_ball_counts[i], NULL);
+        bench_update(&bench, BOARD_ENORMOUS, stress_ball_counts[i], jobs);
+    }
+    job_pool_destroy(jobs);
+    bench_advance(&bench, BOARD_FULL, BALL_LIMIT, 1.0f);
+    bench_advance(&bench, BOARD_FULL, BALL_LIMIT, 4.0f);
+    bench_advance(&bench, BOARD_HALF, BALL_LIMIT, 4.0f);
+    for (int i = 0; i < (int)SDL_arraysize(particle_counts); i++) {
+        bench_particles(&bench, particle_counts[i]);
+    }
+    bench_snapshot(&bench, BOARD_FULL, BALL_LIMIT, 1000);
+    bench_snapshot(&bench, BOARD_ENORMOUS, BALL_LIMIT, 1000);
+    bench_snapshot(&bench, BOARD_ENORMOUS, MAX_BALLS, 30000);
+    bench_rewind(&bench, BOARD_FULL, BALL_LIMIT);
+    bench_rewind(&bench, BOARD_ENORMOUS, BALL_LIMIT);
+    bench_rewind(&bench, BOARD_FULL, MAX_BALLS);
+    bench_netplay_rollback(&bench, false);
+    bench_netplay_rollback(&bench, true);
+    bench_bot_update(&bench, BOARD_FULL, BALL_LIMIT);
+    bench_bot_update(&bench, BOARD_ENORMOUS, BALL_LIMIT);
+    bench_bot_update(&bench, BOARD_FULL, MAX_BALLS);
+    bench_bot_play(&bench, BOARD_FULL);
+    bench_bot_play(&bench, BOARD_ENORMOUS);
+
+    if (render) {
+        App* app = malloc(sizeof(App));
+        SDL_Surface* target = NULL;
+        TTF_Init();
+        if (open_offscreen_app(app, &target)) {
+            for (int fill = 0; fill < BOARD_COUNT; fill++) {
+                bench_render(&bench, app, fill, 1);
+                bench_render(&bench, app, fill, BALL_LIMIT);
+            }
+            for (int i = 0; i < (int)SDL_arraysize(stress_ball_counts); i++) {
+                bench_render(&bench, app, BOARD_FULL, stress_ball_counts[i]);
+            }
+            for (int i = 0; i < (int)SDL_arraysize(particle_counts); i++) {
+                bench_render_particles(&bench, app, particle_counts[i]);
+            }
+        }
+        close_offscreen_app(app, target);
+        free(app);
+        TTF_Quit();
+    }
+
+    bool ok = json_path == NULL || write_json(&bench, json_path, label);
+    free(bench.sample_ns);
+    SDL_Quit();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+#ifndef BRICKED_UP_BITSET_H
+#define BRICKED_UP_BITSET_H
+
+// Fixed-size bitsets stored as arrays of 64-bit words, with bit i in word i / 64.
+// Loops over set bits walk words and peel bits with ctz, so they cost one word per 64
+// entries plus one iteration per set bit.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#define BITSET_WORDS(bits) (((bits) + 63) / 64)
+
+static inline bool bitset_test(const Uint64* set, int i) {
+    return (set[i >> 6] >> (i & 63)) & 1;
+}
+
+static inline void bitset_set(Uint64* set, int i) {
+    set[i >> 6] |= 1ull << (i & 63);
+}
+
+static inline void bitset_clear(Uint64* set, int i) {
+    set[i >> 6] &= ~(1ull << (i & 63));
+}
+
+// Index of the lowest set bit; `word` must not be 0
+static inline int bitset_ctz(Uint64 word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (int)index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+static inline int bitset_popcount(Uint64 word) {
+#ifdef _MSC_VER
+    return (int)__popcnt64(word);
+#else
+    return __builtin_popcountll(word);
+#endif
+}
+
+// Word `word` of `set` with only the bits in [first, end) kept
+static inline Uint64 bitset_word_in_range(const Uint64* set, int word, int first, int end) {
+    Uint64 bits = set[word];
+    int base = word * 64;
+    if (first > base) bits &= ~0ull << (first - base);
+    if (end < base + 64) bits &= (1ull << (end - base)) - 1;
+    return bits;
+}
+
+#endif
@@ -0,0 +1,277 @@
+#include "bot.h"
+#include <math.h>
+#include <string.h>
+
+void bot_init(Bot* bot) {
+    memset(bot, 0, sizeof(Bot));
+    bot->target_brick = -1;
+}
+
+bool bot_predict_ball(const GameState* gs, const Ball* ball, int* budget, float* x, float* seconds) {
+    SDL_FRect box = ball->rect;
+    SDL_FPoint vel = { ball->vel_x, ball->vel_y };
+    float elapsed = 0.0f;
+
+    for (int segment = 0; segment < BOT_MAX_SEGMENTS && *budget > 0; segment++) {
+        float time = BOT_SEGMENT_SECONDS;
+        bool reaches_paddle = false;
+        if (vel.y > 0.0f && (gs->paddle.y - (box.y + box.h)) / vel.y <= time) {
+            time = SDL_max((gs->paddle.y - (box.y + box.h)) / vel.y, 0.0f);
+            reaches_paddle = true;
+        }
+
+        // What the sweep costs goes by the grid cells under the swept box
+        SDL_FRect swept = { SDL_min(box.x, box.x + vel.x * time), SDL_min(box.y, box.y + vel.y * time),
+            box.w + fabsf(vel.x * time), box.h + fabsf(vel.y * time) };
+        int row_min, row_max, col_min, col_max;
+        int cells = 1;
+        if (brick_grid_query(&gs->brick_grid, swept, &row_min, &row_max, &col_min, &col_max)) {
+            cells = SDL_max((row_max - row_min + 1) * (col_max - col_min + 1), 1);
+        }
+        if (cells > *budget) break;
+        *budget -= cells;
+
+        // As in move_ball: the earliest hit wins, and hits at the same time add their normals
+        float normal_x = 0.0f, normal_y = 0.0f;
+        int hit_bricks[MAX_SIMULTANEOUS_HITS];
+        int hits = sweep_bricks(&gs->bricks, &gs->brick_grid, box, vel, &time, &normal_x, &normal_y, hit_bricks);
+        for (int i = 0; i < SIM_WALL_COUNT; i++) {
+            float nx, ny;
+            float t = swept_aabb(box, vel, sim_walls[i], &nx, &ny);
+            if (t < time) {
+                time = t;
+                normal_x = nx;
+                normal_y = ny;
+                hits = 1;
+            } else if (t == time) {
+                normal_x += nx;
+                normal_y += ny;
+                hits++;
+            }
+        }
+
+        box.x += vel.x * time;
+        box.y += vel.y * time;
+        elapsed += time;
+        if (hits > 0) {
+            float magnitude = sqrtf(normal_x * normal_x + normal_y * normal_y);
+            if (magnitude > 0.0f) {
+                float dot_product = (vel.x * normal_x + vel.y * normal_y) / magnitude;
+                vel.x -= 2 * dot_product * normal_x / magnitude;
+                vel.y -= 2 * dot_product * normal_y / magnitude;
+            }
+        } else if (reaches_paddle) {
+            *x = box.x + box.w / 2.0f;
+            *seconds = elapsed;
+            return true;
+        }
+    }
+    return false;
+}
+
+// A rough guess at how soon a ball comes down, from its height alone, to pick which to trace
+static float time_to_paddle(const GameState* gs, const Ball* ball) {
+    float bottom = ball->rect.y + ball->rect.h;
+    if (ball->vel_y > 0.0f) {
+        return (gs->paddle.y - bottom) / ball->vel_y;
+    }
+    // Up to the top wall and back down
+    return (ball->rect.y - TOP_MARGIN + gs->paddle.y - TOP_MARGIN) / SDL_max(-ball->vel_y, 1.0f);
+}
+
+// The next brick to aim at: one that is still solid, spread over the board from one pick
+// to the next so the ball doesn't keep going back to the same spot
+static int pick_target(Bot* bot, const BrickField* bricks) {
+    int words = BITSET_WORDS(bricks->count);
+    if (words == 0) return -1;
+
+    int pick = bot->retargets++;
+    int start = (int)(((unsigned)pick * 7919u) % (unsigned)words);
+    for (int i = 0; i < words; i++) {
+        int w = (start + i) % words;
+        Uint64 bits = bricks->collidable[w];
+        if (bits == 0) continue;
+        for (int skip = pick % bitset_popcount(bits); skip > 0; skip--) {
+            bits &= bits - 1;
+        }
+        return w * 64 + bitset_ctz(bits);
+    }
+    return -1;
+}
+
+// Where the paddle's center will be `seconds` from now, heading for `target_x`
+static float paddle_center_at(const GameState* gs, float target_x, float seconds) {
+    float center = gs->paddle.x + gs->paddle.w / 2.0f;
+    float reach = PADDLE_SPEED * SDL_max(seconds - BOT_SPEED_UP_SECONDS, 0.0f);
+    return center + SDL_clamp(target_x - center, -reach, reach);
+}
+
+// Whether the paddle, heading for `target_x`, is under `powerup` at any point while it
+// falls past the paddle's top
+static bool catches(const GameState* gs, const PowerUp* powerup, float target_x) {
+    float arrives = SDL_max((gs->paddle.y - (powerup->rect.y + powerup->rect.h)) / POWERUP_SPEED, 0.0f);
+    float passes = (gs->paddle.y + gs->paddle.h - powerup->rect.y) / POWERUP_SPEED;
+    float first = paddle_center_at(gs, target_x, arrives);
+    float last = paddle_center_at(gs, target_x, passes);
+    float half_w = gs->paddle.w / 2.0f + BOT_DODGE_MARGIN;
+    return SDL_min(first, last) - half_w < powerup->rect.x + powerup->rect.w && SDL_max(first, last) + half_w > powerup->rect.x;
+}
+
+static bool helpful(const PowerUp* powerup) {
+    return powerup->active && (powerup->type == POWERUP_ADD_LIFE || powerup->type == POWERUP_PADDLE_WIDER);
+}
+
+static bool harmful(const PowerUp* powerup) {
+    return powerup->active && (powerup->type == POWERUP_REMOVE_LIFE || powerup->type == POWERUP_PADDLE_NARROWER);
+}
+
+// Moves `target_x` under a power-up that adds a life or widens the paddle, if the paddle
+// can get there in time and still get back under the ball
+static float catch_powerups(const Bot* bot, const GameState* gs, float target_x) {
+    for (int i = 0; i < MAX_POWERUPS; i++) {
+        const PowerUp* powerup = &gs->powerups[i];
+        if (!helpful(powerup) || powerup->rect.y > gs->paddle.y + gs->paddle.h || catches(gs, powerup, target_x)) continue;
+
+        float arrives = SDL_max((gs->paddle.y - (powerup->rect.y + powerup->rect.h)) / POWERUP_SPEED, 0.0f);
+        float x = powerup->rect.x + powerup->rect.w / 2.0f;
+        float back = fabsf(target_x - x) / PADDLE_SPEED + BOT_SPEED_UP_SECONDS;
+        if (catches(gs, powerup, x) && (!bot->intercepting || arrives + back < bot->intercept_seconds)) {
+            return x;
+        }
+    }
+    return target_x;
+}
+
+// Whether heading for `x` keeps the paddle out from under the harmful power-ups that land
+// before the ball, and, when a ball is coming, still gets it there in time
+static bool safe_target(const Bot* bot, const GameState* gs, float x) {
+    float half_w = gs->paddle.w / 2.0f;
+    if (x < BORDER_THICKNESS + half_w || x > SCREEN_WIDTH - BORDER_THICKNESS - half_w) return false;
+    for (int i = 0; i < MAX_POWERUPS; i++) {
+        const PowerUp* powerup = &gs->powerups[i];
+        if (!harmful(powerup) || powerup->rect.y > gs->paddle.y + gs->paddle.h) continue;
+        float arrives = (gs->paddle.y - (powerup->rect.y + powerup->rect.h)) / POWERUP_SPEED;
+        if (bot->intercepting && bot->intercept_seconds < arrives) continue; // the ball comes first
+        if (catches(gs, powerup, x)) return false;
+    }
+    return true;
+}
+
+// Moves `target_x` so the paddle stays out from under harmful power-ups. First it tries
+// meeting the ball further along the paddle, giving up some aim, then moving aside and
+// coming back for the ball once they have passed.
+static float dodge_powerups(const Bot* bot, const GameState* gs, float target_x) {
+    bool threatened = false;
+    for (int i = 0; i < MAX_POWERUPS && !threatened; i++) {
+        threatened = harmful(&gs->powerups[i]);
+    }
+    if (!threatened || safe_target(bot, gs, target_x)) return target_x;
+
+    float half_w = gs->paddle.w / 2.0f;
+    if (bot->intercepting) {
+        for (int k = 1; k <= BOT_DODGE_STEPS; k++) {
+            for (int side = -1; side <= 1; side += 2) {
+                float x = bot->intercept_x + side * k * (half_w - BOT_DODGE_MARGIN) / BOT_DODGE_STEPS;
+                float travel = fabsf(x - (gs->paddle.x + half_w)) / PADDLE_SPEED + BOT_SPEED_UP_SECONDS;
+                if (travel < bot->intercept_seconds && safe_target(bot, gs, x)) return x;
+            }
+        }
+    }
+    for (int i = 0; i < MAX_POWERUPS; i++) {
+        const PowerUp* powerup = &gs->powerups[i];
+        if (!harmful(powerup) || powerup->rect.y > gs->paddle.y + gs->paddle.h) continue;
+
+        float passes = (gs->paddle.y + gs->paddle.h - powerup->rect.y) / POWERUP_SPEED;
+        float sides[2] = {
+            powerup->rect.x - half_w - BOT_DODGE_MARGIN - 1.0f,
+            powerup->rect.x + powerup->rect.w + half_w + BOT_DODGE_MARGIN + 1.0f,
+        };
+        for (int s = 0; s < 2; s++) {
+            float back = fabsf(target_x - sides[s]) / PADDLE_SPEED + BOT_SPEED_UP_SECONDS;
+            if ((!bot->intercepting || passes + back < bot->intercept_seconds) && safe_target(bot, gs, sides[s])) {
+                return sides[s];
+            }
+        }
+    }
+    return target_x;
+}
+
+int bot_update(Bot* bot, const GameState* gs, SimInput* inputs) {
+    int count = 0;
+    float paddle_center = gs->paddle.x + gs->paddle.w / 2.0f;
+    bool serve = !gs->ball_launched;
+
+    // The balls due soonest, soonest first
+    int candidates[BOT_CANDIDATE_BALLS];
+    float candidate_times[BOT_CANDIDATE_BALLS];
+    int candidate_count = 0;
+    for (int i = 0; i < gs->ball_count; i++) {
+        const Ball* ball = &gs->balls[i];
+        if (ball->is_stuck) serve = true;
+        if (ball->is_stuck || !gs->ball_launched || ball->rect.y > gs->paddle.y + gs->paddle.h) continue;
+
+        float t = time_to_paddle(gs, ball);
+        if (candidate_count == BOT_CANDIDATE_BALLS && t >= candidate_times[candidate_count - 1]) continue;
+        int slot = candidate_count < BOT_CANDIDATE_BALLS ? candidate_count++ : candidate_count - 1;
+        while (slot > 0 && candidate_times[slot - 1] > t) {
+            candidates[slot] = candidates[slot - 1];
+            candidate_times[slot] = candidate_times[slot - 1];
+            slot--;
+        }
+        candidates[slot] = i;
+        candidate_times[slot] = t;
+    }
+
+    int budget = BOT_CELL_BUDGET;
+    bot->intercepting = false;
+    for (int c = 0; c < candidate_count && budget > 0; c++) {
+        float x, seconds;
+        if (bot_predict_ball(gs, &gs->balls[candidates[c]], &budget, &x, &seconds) &&
+            (!bot->intercepting || seconds < bot->intercept_seconds)) {
+            bot->intercepting = true;
+            bot->intercept_x = x;
+            bot->intercept_seconds = seconds;
+        }
+    }
+    bot->cells = BOT_CELL_BUDGET - budget;
+
+    float target_x = paddle_center;
+    if (bot->intercepting) {
+        // launch_ball turns the bounce by up to 45 degrees, in proportion to where the ball meets the paddle
+        if (bot->target_brick < 0 || !bitset_test(gs->bricks.collidable, bot->target_brick)) {
+            bot->target_brick = pick_target(bot, &gs->bricks);
+        }
+        float angle = 0.0f;
+        if (bot->target_brick >= 0) {
+            SDL_FRect brick = brick_rect(&gs->bricks, bot->target_brick);
+            float dx = brick.x + brick.w / 2.0f - bot->intercept_x;
+            float dy = gs->paddle.y - BALL_SIZE / 2.0f - (brick.y + brick.h / 2.0f);
+            angle = SDL_clamp(atan2f(dx, dy), -BOT_MAX_AIM_ANGLE, BOT_MAX_AIM_ANGLE);
+        }
+        target_x = bot->intercept_x - angle / (float)(M_PI / 4.0) * gs->paddle.w / 2.0f;
+    } else if (candidate_count > 0) {
+        const Ball* ball = &gs->balls[candidates[0]];
+        target_x = ball->rect.x + ball->rect.w / 2.0f;
+    }
+    target_x = catch_powerups(bot, gs, target_x);
+    target_x = dodge_powerups(bot, gs, target_x);
+    target_x = SDL_clamp(target_x, BORDER_THICKNESS + gs->paddle.w / 2.0f, SCREEN_WIDTH - BORDER_THICKNESS - gs->paddle.w / 2.0f);
+
+    // Releasing a key stops the paddle at once, so keep going until the target is passed
+    // rather than until it is near, which would stop short and then creep up on it
+    float error = target_x - paddle_center;
+    bool left = bot->left ? error < 0.0f : error < -BOT_TOLERANCE;
+    bool right = bot->right ? error > 0.0f : error > BOT_TOLERANCE;
+    if (left != bot->left) {
+        inputs[count++] = left ? SIM_INPUT_LEFT_DOWN : SIM_INPUT_LEFT_UP;
+        bot->left = left;
+    }
+    if (right != bot->right) {
+        inputs[count++] = right ? SIM_INPUT_RIGHT_DOWN : SIM_INPUT_RIGHT_UP;
+        bot->right = right;
+    }
+    if (serve) {
+        inputs[count++] = SIM_INPUT_LAUNCH;
+    }
+    return count;
+}
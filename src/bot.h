@@ -0,0 +1,55 @@
+#ifndef BRICKED_UP_BOT_H
+#define BRICKED_UP_BOT_H
+
+// A player that reads the game instead of the screen, for unattended soak tests and
+// benchmark workloads. Every frame it traces the balls forward with the same sweeps and
+// walls move_ball uses, finds where the next one will come down to the paddle, and
+// steers there, placing the paddle so the bounce heads for a brick that is still up. It
+// goes for the power-ups that help and stays out from under the ones that hurt when it
+// has time to.
+// It only ever answers with SimInputs, so the game takes them like key presses.
+//
+// The tracing is capped at BOT_CELL_BUDGET brick grid cells swept a frame, however many
+// balls there are and however fine the board's grid. A ball deep in a big board can take
+// more than that to trace; the bot then just follows it until it comes out.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include "sim.h"
+
+#define BOT_SEGMENT_SECONDS 0.05f // looked ahead by one sweep; short, so a sweep covers few grid cells on big boards
+#define BOT_MAX_SEGMENTS 64 // per ball, about 3 seconds ahead
+#define BOT_CELL_BUDGET 2048 // grid cells swept per bot_update, across all the balls it traces; a sweep outside the bricks counts as one
+#define BOT_CANDIDATE_BALLS 8 // of many balls, only the ones due soonest are traced
+#define BOT_MAX_AIM_ANGLE 0.52f // radians off vertical the bot aims a bounce; launch_ball allows 45 degrees
+#define BOT_TOLERANCE 4.0f // pixels the paddle may be off before it moves
+#define BOT_DODGE_MARGIN 6.0f // pixels kept between the paddle and a power-up it dodges, and between the ball and the paddle's ends
+#define BOT_DODGE_STEPS 4 // places tried on each side of the ball when dodging with the paddle under it
+#define BOT_SPEED_UP_SECONDS 0.1f // what the paddle loses to its acceleration on a move, about 1 / PADDLE_ACCELERATION
+#define BOT_MAX_INPUTS 3 // what one bot_update can ask for
+
+typedef struct {
+    bool left; // keys the bot holds down, as it last asked
+    bool right;
+    int target_brick; // aimed at until it stops being solid, -1 for none yet
+    int retargets;
+    int cells; // of the budget spent by the last bot_update
+    bool intercepting; // the last bot_update found where a ball comes down
+    float intercept_x; // ball center there
+    float intercept_seconds; // from now
+} Bot;
+
+void bot_init(Bot* bot);
+
+// Where `ball` will be when its bottom edge comes down to the top of the paddle, tracing
+// at most BOT_MAX_SEGMENTS sweeps and taking the grid cells each covers from `*budget`. Bricks are taken as
+// they are now, so a brick the ball breaks on the way still bounces it later. Returns
+// false when the ball doesn't get there within that or the budget ran out.
+bool bot_predict_ball(const GameState* gs, const Ball* ball, int* budget, float* x, float* seconds);
+
+// Looks at `gs` and writes the inputs it wants now to `inputs` (room for BOT_MAX_INPUTS),
+// returning how many. Key changes are only asked for once, so the caller must apply them
+// all, through whatever path keyboard input takes.
+int bot_update(Bot* bot, const GameState* gs, SimInput* inputs);
+
+#endif
@@ -0,0 +1,79 @@
+#include "frame_pacer.h"
+#include <stdio.h>
+#include <string.h>
+
+const char* pacing_mode_names[PACING_MODE_COUNT] = { "vsync", "limit", "uncapped" };
+
+static float display_refresh_hz(SDL_Window* window) {
+    const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window));
+    if (mode == NULL || mode->refresh_rate <= 0.0f) return FRAME_PACER_DEFAULT_HZ;
+    return mode->refresh_rate;
+}
+
+bool frame_pacer_init(FramePacer* pacer, SDL_Window* window, SDL_Renderer* renderer, PacingMode mode, float hz) {
+    memset(pacer, 0, sizeof(FramePacer));
+    pacer->mode = mode;
+    pacer->target_hz = hz > 0.0f ? hz : display_refresh_hz(window);
+    pacer->period_ns = (Uint64)(SDL_NS_PER_SECOND / pacer->target_hz);
+    pacer->spin_ns = SDL_NS_PER_MS;
+
+    if (!SDL_SetRenderVSync(renderer, mode == PACING_VSYNC ? 1 : SDL_RENDERER_VSYNC_DISABLED)) {
+        if (mode != PACING_VSYNC) {
+            printf("Failed to turn off VSync: %s\n", SDL_GetError());
+            return false;
+        }
+        printf("VSync unavailable, limiting to %.0f Hz instead: %s\n", pacer->target_hz, SDL_GetError());
+        pacer->mode = PACING_LIMIT;
+    }
+    return true;
+}
+
+// Sleeps until `spin_ns` before the deadline, then spins. The spin margin follows the
+// worst recent oversleep so a jittery scheduler costs a little CPU rather than a frame.
+static void wait_until(FramePacer* pacer, Uint64 deadline_ns) {
+    Uint64 now = SDL_GetTicksNS();
+    if (deadline_ns > now + pacer->spin_ns) {
+        Uint64 wake_ns = deadline_ns - pacer->spin_ns;
+        SDL_DelayNS(wake_ns - now);
+        now = SDL_GetTicksNS();
+
+        Uint64 oversleep_ns = now > wake_ns ? now - wake_ns : 0;
+        Uint64 spin_ns = pacer->spin_ns - pacer->spin_ns / 16; // decay back down slowly
+        if (oversleep_ns + FRAME_PACER_MIN_SPIN_NS > spin_ns) spin_ns = oversleep_ns + FRAME_PACER_MIN_SPIN_NS;
+        pacer->spin_ns = SDL_clamp(spin_ns, FRAME_PACER_MIN_SPIN_NS, FRAME_PACER_MAX_SPIN_NS);
+    }
+    while (now < deadline_ns) {
+        now = SDL_GetTicksNS();
+    }
+}
+
+bool frame_pacer_wait(FramePacer* pacer) {
+    bool missed = false;
+    Uint64 now = SDL_GetTicksNS();
+
+    switch (pacer->mode) {
+        case PACING_VSYNC:
+            // The present already blocked; a frame that spanned more than one refresh missed one
+            missed = pacer->last_frame_ns != 0 && now - pacer->last_frame_ns > pacer->period_ns + pacer->period_ns / 2;
+            break;
+        case PACING_LIMIT:
+            if (pacer->deadline_ns == 0) {
+                pacer->deadline_ns = now + pacer->period_ns;
+            } else if (now > pacer->deadline_ns) {
+                // Late: start the next frame now instead of rushing several to catch up
+                missed = true;
+                pacer->deadline_ns = now;
+            }
+            wait_until(pacer, pacer->deadline_ns);
+            pacer->deadline_ns += pacer->period_ns;
+            break;
+        case PACING_UNCAPPED:
+        case PACING_MODE_COUNT:
+            break;
+    }
+
+    pacer->last_frame_ns = SDL_GetTicksNS();
+    pacer->frames++;
+    if (missed) pacer->missed++;
+    return missed;
+}
@@ -0,0 +1,42 @@
+#ifndef BRICKED_UP_FRAME_PACER_H
+#define BRICKED_UP_FRAME_PACER_H
+
+// Decides when the next frame starts. VSync leaves it to the present; the limiter sleeps
+// most of the way to the next deadline and spins the rest, since a plain sleep can
+// overshoot by a millisecond or more; uncapped starts the next frame right away.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#define FRAME_PACER_DEFAULT_HZ 60.0f // when the display doesn't report its refresh rate
+#define FRAME_PACER_MIN_SPIN_NS (SDL_NS_PER_MS / 4)
+#define FRAME_PACER_MAX_SPIN_NS (4 * SDL_NS_PER_MS)
+
+typedef enum {
+    PACING_VSYNC,
+    PACING_LIMIT,
+    PACING_UNCAPPED,
+    PACING_MODE_COUNT
+} PacingMode;
+
+typedef struct {
+    PacingMode mode;
+    float target_hz;
+    Uint64 period_ns;
+    Uint64 deadline_ns; // when the next frame should start, limiter only
+    Uint64 last_frame_ns; // start of the previous frame, for spotting missed vsyncs
+    Uint64 spin_ns; // how long before a deadline to stop sleeping, grows with oversleep
+    Uint64 frames;
+    Uint64 missed;
+} FramePacer;
+
+extern const char* pacing_mode_names[PACING_MODE_COUNT];
+
+// Targets `hz`, or the refresh rate of the window's display when it is 0. Falls back to
+// the limiter if VSync can't be turned on.
+bool frame_pacer_init(FramePacer* pacer, SDL_Window* window, SDL_Renderer* renderer, PacingMode mode, float hz);
+
+// Call once per frame after presenting. Returns whether this frame missed its deadline.
+bool frame_pacer_wait(FramePacer* pacer);
+
+#endif
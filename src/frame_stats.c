@@ -0,0 +1,115 @@
+#include "frame_stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+const char* frame_phase_names[FRAME_PHASE_COUNT] = { "events", "update", "render", "present" };
+
+void frame_stats_init(FrameStats* stats) {
+    memset(stats, 0, sizeof(FrameStats));
+}
+
+bool frame_stats_open_log(FrameStats* stats, const char* path) {
+    stats->log = fopen(path, "w");
+    if (stats->log == NULL) {
+        printf("Failed to open frame log: %s\n", path);
+        return false;
+    }
+    fprintf(stats->log, "frame,time_ms,events_ms,update_ms,steps,render_ms,present_ms,frame_ms,missed,input_latency_ms\n");
+    return true;
+}
+
+void frame_stats_close(FrameStats* stats) {
+    if (stats->log != NULL) {
+        fclose(stats->log);
+        stats->log = NULL;
+    }
+}
+
+static void finish_frame(FrameStats* stats, Uint64 now) {
+    FrameTiming* frame = &stats->current;
+    frame->frame_ns = now - stats->frame_start_ns;
+
+    stats->history[stats->history_next] = *frame;
+    stats->history_next = (stats->history_next + 1) % FRAME_HISTORY;
+    if (stats->history_count < FRAME_HISTORY) stats->history_count++;
+
+    if (stats->log != NULL) {
+        fprintf(stats->log, "%llu,%.3f,%.3f,%.3f,%llu,%.3f,%.3f,%.3f,%d,%.3f\n",
+            (unsigned long long)stats->frame_index,
+            (stats->frame_start_ns - stats->first_frame_ns) / 1e6,
+            frame->phase_ns[FRAME_PHASE_EVENTS] / 1e6,
+            frame->phase_ns[FRAME_PHASE_UPDATE] / 1e6,
+            (unsigned long long)frame->steps,
+            frame->phase_ns[FRAME_PHASE_RENDER] / 1e6,
+            frame->phase_ns[FRAME_PHASE_PRESENT] / 1e6,
+            frame->frame_ns / 1e6,
+            frame->missed ? 1 : 0,
+            frame->input_latency_ns / 1e6);
+    }
+    stats->frame_index++;
+}
+
+void frame_stats_begin_frame(FrameStats* stats) {
+    Uint64 now = SDL_GetTicksNS();
+    if (stats->frame_start_ns != 0) {
+        finish_frame(stats, now);
+    } else {
+        stats->first_frame_ns = now;
+    }
+    memset(&stats->current, 0, sizeof(FrameTiming));
+    stats->frame_start_ns = now;
+    stats->mark_ns = now;
+}
+
+void frame_stats_mark(FrameStats* stats, FramePhase phase) {
+    Uint64 now = SDL_GetTicksNS();
+    stats->current.phase_ns[phase] += now - stats->mark_ns;
+    stats->mark_ns = now;
+}
+
+const FrameTiming* frame_stats_recent(const FrameStats* stats, int i) {
+    return &stats->history[(stats->history_next - 1 - i + FRAME_HISTORY) % FRAME_HISTORY];
+}
+
+static int compare_u64(const void* a, const void* b) {
+    Uint64 x = *(const Uint64*)a;
+    Uint64 y = *(const Uint64*)b;
+    return (x > y) - (x < y);
+}
+
+static void summarize_values(Uint64* values, int count, FrameSummary* summary) {
+    if (count == 0) {
+        summary->p50_ms = summary->p99_ms = summary->max_ms = 0.0;
+        return;
+    }
+    qsort(values, count, sizeof(Uint64), compare_u64);
+    summary->p50_ms = values[count / 2] / 1e6;
+    summary->p99_ms = values[(count * 99) / 100] / 1e6;
+    summary->max_ms = values[count - 1] / 1e6;
+}
+
+void frame_stats_summarize(const FrameStats* stats, FrameSummary summaries[FRAME_PHASE_COUNT + 1]) {
+    Uint64 values[FRAME_HISTORY];
+    int count = stats->history_count;
+
+    for (int p = 0; p <= FRAME_PHASE_COUNT; p++) {
+        for (int i = 0; i < count; i++) {
+            const FrameTiming* frame = &stats->history[i];
+            values[i] = p < FRAME_PHASE_COUNT ? frame->phase_ns[p] : frame->frame_ns;
+        }
+        summarize_values(values, count, &summaries[p]);
+    }
+}
+
+int frame_stats_summarize_latency(const FrameStats* stats, FrameSummary* summary) {
+    Uint64 values[FRAME_HISTORY];
+    int count = 0;
+
+    for (int i = 0; i < stats->history_count; i++) {
+        if (stats->history[i].input_latency_ns > 0) {
+            values[count++] = stats->history[i].input_latency_ns;
+        }
+    }
+    summarize_values(values, count, summary);
+    return count;
+}
@@ -0,0 +1,68 @@
+#ifndef BRICKED_UP_FRAME_STATS_H
+#define BRICKED_UP_FRAME_STATS_H
+
+// Per-phase frame timings: a rolling history for the debug overlay and an optional CSV
+// log with one row per frame. The main loop calls frame_stats_begin_frame once per frame
+// and frame_stats_mark after each phase; the time since the previous mark goes to that phase,
+// adding up when a phase is marked more than once in a frame.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define FRAME_HISTORY 240 // four seconds at 60 fps
+
+typedef enum {
+    FRAME_PHASE_EVENTS,
+    FRAME_PHASE_UPDATE,
+    FRAME_PHASE_RENDER,
+    FRAME_PHASE_PRESENT,
+    FRAME_PHASE_COUNT
+} FramePhase;
+
+typedef struct {
+    Uint64 phase_ns[FRAME_PHASE_COUNT];
+    Uint64 frame_ns; // start of this frame to the start of the next, sleeping included
+    Uint64 steps; // fixed simulation steps run this frame
+    bool missed; // finished after the frame pacer's deadline
+    Uint64 input_latency_ns; // oldest input first shown by this frame's present, to the end of it; 0 if none
+} FrameTiming;
+
+typedef struct {
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+} FrameSummary;
+
+typedef struct {
+    FrameTiming current;
+    FrameTiming history[FRAME_HISTORY]; // ring buffer, oldest at history_next once full
+    int history_count;
+    int history_next;
+    Uint64 frame_index;
+    Uint64 first_frame_ns;
+    Uint64 frame_start_ns;
+    Uint64 mark_ns;
+    FILE* log;
+} FrameStats;
+
+extern const char* frame_phase_names[FRAME_PHASE_COUNT];
+
+void frame_stats_init(FrameStats* stats);
+bool frame_stats_open_log(FrameStats* stats, const char* path);
+void frame_stats_close(FrameStats* stats);
+
+void frame_stats_begin_frame(FrameStats* stats);
+void frame_stats_mark(FrameStats* stats, FramePhase phase);
+
+// `i` frames back from the newest finished frame; i must be below history_count.
+const FrameTiming* frame_stats_recent(const FrameStats* stats, int i);
+
+// One summary per phase, then one for whole frames, over the frames in the history.
+void frame_stats_summarize(const FrameStats* stats, FrameSummary summaries[FRAME_PHASE_COUNT + 1]);
+
+// Input-to-present latency over the frames in the history that showed an input. Returns
+// how many did.
+int frame_stats_summarize_latency(const FrameStats* stats, FrameSummary* summary);
+
+#endif
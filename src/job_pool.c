@@ -0,0 +1,229 @@
+#include "job_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define JOB_DEQUE_INITIAL_CAPACITY 64
+
+typedef struct {
+    JobFn fn;
+    void* data;
+} Job;
+
+// Ring buffer guarded by its own lock. The owner works at the back, thieves at the front.
+typedef struct {
+    SDL_Mutex* lock;
+    Job* jobs;
+    int capacity;
+    int head;
+    int count;
+} JobDeque;
+
+typedef struct {
+    JobPool* pool;
+    int index;
+} WorkerStart;
+
+struct JobPool {
+    int worker_count;
+    JobDeque* deques;
+    SDL_Thread** threads;
+    WorkerStart* starts;
+    SDL_AtomicInt queued;   // jobs sitting in a deque
+    SDL_AtomicInt unfinished; // jobs submitted but not yet completed
+    SDL_AtomicInt next_deque;
+    SDL_AtomicInt shutting_down;
+    SDL_Mutex* sleep_lock;
+    SDL_Condition* work_available;
+    SDL_Condition* all_done;
+};
+
+// False, with the deque left as it was, if it was full and couldn't grow
+static bool deque_push_back(JobDeque* deque, Job job) {
+    SDL_LockMutex(deque->lock);
+    if (deque->count == deque->capacity) {
+        int new_capacity = deque->capacity * 2;
+        Job* jobs = malloc(sizeof(Job) * new_capacity);
+        if (jobs == NULL) {
+            SDL_UnlockMutex(deque->lock);
+            return false;
+        }
+        for (int i = 0; i < deque->count; i++) {
+            jobs[i] = deque->jobs[(deque->head + i) % deque->capacity];
+        }
+        free(deque->jobs);
+        deque->jobs = jobs;
+        deque->capacity = new_capacity;
+        deque->head = 0;
+    }
+    deque->jobs[(deque->head + deque->count) % deque->capacity] = job;
+    deque->count++;
+    SDL_UnlockMutex(deque->lock);
+    return true;
+}
+
+static bool deque_pop_back(JobDeque* deque, Job* job) {
+    bool found = false;
+    SDL_LockMutex(deque->lock);
+    if (deque->count > 0) {
+        deque->count--;
+        *job = deque->jobs[(deque->head + deque->count) % deque->capacity];
+        found = true;
+    }
+    SDL_UnlockMutex(deque->lock);
+    return found;
+}
+
+static bool deque_steal_front(JobDeque* deque, Job* job) {
+    bool found = false;
+    if (!SDL_TryLockMutex(deque->lock)) return false; // busy deque: try another victim
+    if (deque->count > 0) {
+        *job = deque->jobs[deque->head];
+        deque->head = (deque->head + 1) % deque->capacity;
+        deque->count--;
+        found = true;
+    }
+    SDL_UnlockMutex(deque->lock);
+    return found;
+}
+
+static bool find_job(JobPool* pool, int worker_index, Job* job) {
+    if (deque_pop_back(&pool->deques[worker_index], job)) return true;
+    for (int i = 1; i < pool->worker_count; i++) {
+        int victim = (worker_index + i) % pool->worker_count;
+        if (deque_steal_front(&pool->deques[victim], job)) return true;
+    }
+    return false;
+}
+
+static void run_job(JobPool* pool, Job job, int worker_index) {
+    SDL_AddAtomicInt(&pool->queued, -1);
+    job.fn(job.data, worker_index);
+    if (SDL_AddAtomicInt(&pool->unfinished, -1) == 1) {
+        SDL_LockMutex(pool->sleep_lock);
+        SDL_BroadcastCondition(pool->all_done);
+        SDL_UnlockMutex(pool->sleep_lock);
+    }
+}
+
+// The worker_index of the calling thread: its own for one of the pool's threads, 0 for any
+// other, which is taken to be the one that waits
+static int calling_worker(const JobPool* pool) {
+    SDL_ThreadID self = SDL_GetCurrentThreadID();
+    for (int i = 1; i < pool->worker_count; i++) {
+        if (pool->threads[i] != NULL && SDL_GetThreadID(pool->threads[i]) == self) return i;
+    }
+    return 0;
+}
+
+static int worker_main(void* data) {
+    WorkerStart* start = data;
+    JobPool* pool = start->pool;
+    Job job;
+
+    while (!SDL_GetAtomicInt(&pool->shutting_down)) {
+        if (find_job(pool, start->index, &job)) {
+            run_job(pool, job, start->index);
+            continue;
+        }
+        SDL_LockMutex(pool->sleep_lock);
+        while (SDL_GetAtomicInt(&pool->queued) == 0 && !SDL_GetAtomicInt(&pool->shutting_down)) {
+            SDL_WaitCondition(pool->work_available, pool->sleep_lock);
+        }
+        SDL_UnlockMutex(pool->sleep_lock);
+    }
+    return 0;
+}
+
+JobPool* job_pool_create(int thread_count) {
+    if (thread_count < 0) thread_count = 0;
+
+    JobPool* pool = calloc(1, sizeof(JobPool));
+    if (pool == NULL) return NULL;
+    pool->worker_count = thread_count + 1;
+    pool->deques = calloc(pool->worker_count, sizeof(JobDeque));
+    pool->threads = calloc(pool->worker_count, sizeof(SDL_Thread*));
+    pool->starts = calloc(pool->worker_count, sizeof(WorkerStart));
+    pool->sleep_lock = SDL_CreateMutex();
+    pool->work_available = SDL_CreateCondition();
+    pool->all_done = SDL_CreateCondition();
+
+    for (int i = 0; i < pool->worker_count; i++) {
+        pool->deques[i].lock = SDL_CreateMutex();
+        pool->deques[i].capacity = JOB_DEQUE_INITIAL_CAPACITY;
+        pool->deques[i].jobs = malloc(sizeof(Job) * JOB_DEQUE_INITIAL_CAPACITY);
+    }
+
+    // Worker 0 is whichever thread calls job_pool_wait
+    for (int i = 1; i < pool->worker_count; i++) {
+        pool->starts[i].pool = pool;
+        pool->starts[i].index = i;
+        pool->threads[i] = SDL_CreateThread(worker_main, "job worker", &pool->starts[i]);
+    }
+
+    return pool;
+}
+
+void job_pool_destroy(JobPool* pool) {
+    if (pool == NULL) return;
+
+    SDL_LockMutex(pool->sleep_lock);
+    SDL_SetAtomicInt(&pool->shutting_down, 1);
+    SDL_BroadcastCondition(pool->work_available);
+    SDL_UnlockMutex(pool->sleep_lock);
+
+    for (int i = 1; i < pool->worker_count; i++) {
+        SDL_WaitThread(pool->threads[i], NULL);
+    }
+    for (int i = 0; i < pool->worker_count; i++) {
+        SDL_DestroyMutex(pool->deques[i].lock);
+        free(pool->deques[i].jobs);
+    }
+
+    SDL_DestroyCondition(pool->all_done);
+    SDL_DestroyCondition(pool->work_available);
+    SDL_DestroyMutex(pool->sleep_lock);
+    free(pool->starts);
+    free(pool->threads);
+    free(pool->deques);
+    free(pool);
+}
+
+int job_pool_worker_count(const JobPool* pool) {
+    return pool->worker_count;
+}
+
+void job_pool_submit(JobPool* pool, JobFn fn, void* data) {
+    Job job = { fn, data };
+    int deque = (SDL_AddAtomicInt(&pool->next_deque, 1) & 0x7fffffff) % pool->worker_count;
+
+    SDL_AddAtomicInt(&pool->unfinished, 1);
+    SDL_AddAtomicInt(&pool->queued, 1);
+    if (!deque_push_back(&pool->deques[deque], job)) {
+        printf("Failed to grow a job deque, running the job on the submitting thread\n");
+        run_job(pool, job, calling_worker(pool));
+        return;
+    }
+
+    // The waiting thread sleeps on all_done, so wake it too in case this job was
+    // submitted from inside another job
+    SDL_LockMutex(pool->sleep_lock);
+    SDL_SignalCondition(pool->work_available);
+    SDL_BroadcastCondition(pool->all_done);
+    SDL_UnlockMutex(pool->sleep_lock);
+}
+
+void job_pool_wait(JobPool* pool) {
+    Job job;
+    while (SDL_GetAtomicInt(&pool->unfinished) > 0) {
+        if (find_job(pool, 0, &job)) {
+            run_job(pool, job, 0);
+            continue;
+        }
+        // Nothing left to steal: sleep until the jobs still running elsewhere finish
+        SDL_LockMutex(pool->sleep_lock);
+        while (SDL_GetAtomicInt(&pool->unfinished) > 0 && SDL_GetAtomicInt(&pool->queued) == 0) {
+            SDL_WaitCondition(pool->all_done, pool->sleep_lock);
+        }
+        SDL_UnlockMutex(pool->sleep_lock);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef BRICKED_UP_JOB_POOL_H
+#define BRICKED_UP_JOB_POOL_H
+
+// Work-stealing thread pool. Each worker owns a deque: it pops its own jobs from the
+// back and, when empty, steals from the front of the others. The thread that calls
+// job_pool_wait joins in as worker 0, so a pool of N threads runs N + 1 jobs at once.
+
+#include <SDL3/SDL.h>
+
+typedef void (*JobFn)(void* data, int worker_index);
+
+typedef struct JobPool JobPool;
+
+// `thread_count` background threads; 0 runs every job on the waiting thread.
+JobPool* job_pool_create(int thread_count);
+void job_pool_destroy(JobPool* pool);
+
+// Number of distinct worker_index values jobs can see (threads + the waiting thread).
+int job_pool_worker_count(const JobPool* pool);
+
+// Queues a job. Jobs are spread round-robin over the worker deques. If a deque is full and
+// can't grow, the job runs on the calling thread before this returns.
+void job_pool_submit(JobPool* pool, JobFn fn, void* data);
+
+// Runs queued jobs on the calling thread until every submitted job has finished.
+void job_pool_wait(JobPool* pool);
+
+#endif
@@ -0,0 +1,292 @@
+#include "level_pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define CLASSIC_ROWS 6
+#define CLASSIC_COLS 10
+
+// The original board: one colour per row, every brick breaking in one hit
+static const BrickType classic_types[CLASSIC_ROWS] = {
+    {0, 1, {0, 0}}, {1, 1, {0, 0}}, {2, 1, {0, 0}}, {3, 1, {0, 0}}, {4, 1, {0, 0}}, {5, 1, {0, 0}},
+};
+static const Uint8 classic_cells[CLASSIC_ROWS * CLASSIC_COLS] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+};
+static Level classic_level = { CLASSIC_ROWS, CLASSIC_COLS, CLASSIC_ROWS, classic_types, classic_cells };
+static const LevelPack builtin_pack = { NULL, 0, 1, &classic_level, 0 };
+
+const LevelPack* level_pack_builtin(void) {
+    return &builtin_pack;
+}
+
+static Uint64 fnv1a(Uint64 hash, const Uint8* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+static bool map_file(LevelPack* pack, const char* path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* data = mapping != NULL ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (data == NULL) {
+        if (mapping != NULL) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    pack->file = file;
+    pack->mapping = mapping;
+    pack->data = data;
+    pack->size = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file open
+    if (data == MAP_FAILED) return false;
+    pack->data = data;
+    pack->size = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+static void unmap_file(LevelPack* pack) {
+    if (pack->data == NULL) return;
+#ifdef _WIN32
+    UnmapViewOfFile(pack->data);
+    CloseHandle(pack->mapping);
+    CloseHandle(pack->file);
+#else
+    munmap((void*)pack->data, pack->size);
+#endif
+    pack->data = NULL;
+}
+
+// Counts the cells of `level` that hold a brick, leaving out those naming a type it lacks
+static int filled_cells(const Level* level) {
+    int filled = 0;
+    for (int i = 0; i < level->rows * level->cols; i++) {
+        if (level->cells[i] != 0 && level->cells[i] <= level->type_count) filled++;
+    }
+    return filled;
+}
+
+// Reads the whole file once: the hash has to cover it, and a level with no bricks would
+// count as cleared on every step
+static bool validate_pack(LevelPack* pack, const char* path) {
+    if (pack->size < sizeof(LevelPackHeader)) {
+        printf("Level pack %s is truncated\n", path);
+        return false;
+    }
+    const LevelPackHeader* header = (const LevelPackHeader*)pack->data;
+    if (memcmp(header->magic, "BUPK", 4) != 0) {
+        printf("%s is not a level pack\n", path);
+        return false;
+    }
+    if (header->byte_order != LEVEL_PACK_BYTE_ORDER) {
+        printf("Level pack %s has the wrong byte order for this machine\n", path);
+        return false;
+    }
+    if (header->version != LEVEL_PACK_VERSION) {
+        printf("Level pack %s is version %u, expected %d\n", path, header->version, LEVEL_PACK_VERSION);
+        return false;
+    }
+    if (header->level_count == 0 || header->level_count > (pack->size - sizeof(LevelPackHeader)) / sizeof(LevelPackEntry)) {
+        printf("Level pack %s has a bad level count\n", path);
+        return false;
+    }
+    if (fnv1a(0xCBF29CE484222325ull, pack->data + sizeof(LevelPackHeader), pack->size - sizeof(LevelPackHeader)) != header->content_hash) {
+        printf("Level pack %s is corrupt: its contents don't match its hash\n", path);
+        return false;
+    }
+
+    pack->level_count = (int)header->level_count;
+    pack->content_hash = header->content_hash;
+    pack->levels = calloc(pack->level_count, sizeof(Level));
+    if (pack->levels == NULL) return false;
+
+    const LevelPackEntry* entries = (const LevelPackEntry*)(pack->data + sizeof(LevelPackHeader));
+    for (int i = 0; i < pack->level_count; i++) {
+        const LevelPackEntry* entry = &entries[i];
+        Uint64 types_size = (Uint64)entry->type_count * sizeof(BrickType);
+        Uint64 cells_size = (Uint64)entry->rows * entry->cols;
+        if (entry->rows == 0 || entry->rows > MAX_BRICK_ROWS || entry->cols == 0 || entry->cols > MAX_BRICK_COLS ||
+            entry->type_count == 0 || entry->type_count > 255 || entry->offset % sizeof(Uint32) != 0 ||
+            entry->offset > pack->size || types_size + cells_size > pack->size - entry->offset) {
+            printf("Level %d of %s is malformed\n", i, path);
+            return false;
+        }
+
+        Level* level = &pack->levels[i];
+        level->rows = entry->rows;
+        level->cols = entry->cols;
+        level->type_count = entry->type_count;
+        level->types = (const BrickType*)(pack->data + entry->offset);
+        level->cells = pack->data + entry->offset + types_size;
+        for (int t = 0; t < level->type_count; t++) {
+            if (level->types[t].sprite_row >= BRICK_SPRITE_ROWS || level->types[t].hits == 0) {
+                printf("Level %d of %s has a bad brick type\n", i, path);
+                return false;
+            }
+        }
+        if (filled_cells(level) == 0) {
+            printf("Level %d of %s has no bricks\n", i, path);
+            return false;
+        }
+    }
+    return true;
+}
+
+LevelPack* level_pack_open(const char* path) {
+    LevelPack* pack = calloc(1, sizeof(LevelPack));
+    if (pack == NULL) return NULL;
+
+    if (!map_file(pack, path)) {
+        printf("Failed to map level pack: %s\n", path);
+        free(pack);
+        return NULL;
+    }
+    if (!validate_pack(pack, path)) {
+        level_pack_close(pack);
+        return NULL;
+    }
+    return pack;
+}
+
+void level_pack_close(LevelPack* pack) {
+    if (pack == NULL || pack == &builtin_pack) return;
+    unmap_file(pack);
+    free(pack->levels);
+    free(pack);
+}
+
+const Level* level_pack_level(const LevelPack* pack, int index) {
+    return &pack->levels[index % pack->level_count];
+}
+
+void level_pack_prefetch(const LevelPack* pack, int index) {
+    if (pack->data == NULL) return;
+
+    const Level* level = level_pack_level(pack, index);
+    const Uint8* start = (const Uint8*)level->types;
+    size_t size = level->type_count * sizeof(BrickType) + (size_t)level->rows * level->cols;
+#ifdef _WIN32
+    WIN32_MEMORY_RANGE_ENTRY range = { (void*)start, size };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    // madvise wants a page-aligned start
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const Uint8* aligned = pack->data + ((size_t)(start - pack->data) / page) * page;
+    madvise((void*)aligned, size + (size_t)(start - aligned), MADV_WILLNEED);
+#endif
+}
+
+// SplitMix64 of the seed and cell, so a layout only depends on its arguments
+static Uint64 cell_noise(Uint64 seed, int row, int col) {
+    Uint64 z = seed + 0x9E3779B97F4A7C15ull * (((Uint64)row << 32) | (Uint32)col);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void level_generate(Level* level, Uint8* cells, BrickType* types, int rows, int cols, Uint64 seed) {
+    int pattern = (int)(seed % 4);
+    int block = cols / 8 > 1 ? cols / 8 : 1;
+
+    // Colour bands top to bottom; the top band takes two hits
+    for (int t = 0; t < BRICK_SPRITE_ROWS; t++) {
+        types[t] = (BrickType){ (Uint8)t, (Uint8)(t == 0 ? 2 : 1), {0, 0} };
+    }
+    for (int i = 0; i < rows; i++) {
+        for (int j = 0; j < cols; j++) {
+            float dy = (i + 0.5f) / rows - 0.5f;
+            float dx = (j + 0.5f) / cols - 0.5f;
+            bool filled = true;
+            if (pattern == 1) {
+                filled = (dx < 0 ? -dx : dx) + (dy < 0 ? -dy : dy) < 0.5f; // diamond
+            } else if (pattern == 2) {
+                filled = ((i / block) + (j / block)) % 2 == 0; // checkerboard of blocks
+            } else if (pattern == 3) {
+                filled = cell_noise(seed, i, j) % 5 != 0; // one in five missing
+            }
+            cells[i * cols + j] = filled ? (Uint8)(1 + (i * BRICK_SPRITE_ROWS) / rows) : 0;
+        }
+    }
+
+    level->rows = rows;
+    level->cols = cols;
+    level->type_count = BRICK_SPRITE_ROWS;
+    level->types = types;
+    level->cells = cells;
+}
+
+bool level_pack_write(const char* path, const Level* levels, int level_count) {
+    size_t size = sizeof(LevelPackHeader) + sizeof(LevelPackEntry) * level_count;
+    for (int i = 0; i < level_count; i++) {
+        size += levels[i].type_count * sizeof(BrickType) + (size_t)levels[i].rows * levels[i].cols;
+        size = (size + sizeof(Uint64) - 1) / sizeof(Uint64) * sizeof(Uint64);
+    }
+
+    Uint8* data = calloc(1, size);
+    if (data == NULL) {
+        printf("Failed to allocate level pack\n");
+        return false;
+    }
+    LevelPackHeader* header = (LevelPackHeader*)data;
+    LevelPackEntry* entries = (LevelPackEntry*)(data + sizeof(LevelPackHeader));
+    size_t offset = sizeof(LevelPackHeader) + sizeof(LevelPackEntry) * level_count;
+    for (int i = 0; i < level_count; i++) {
+        const Level* level = &levels[i];
+        size_t types_size = level->type_count * sizeof(BrickType);
+        entries[i].offset = offset;
+        entries[i].rows = (Uint16)level->rows;
+        entries[i].cols = (Uint16)level->cols;
+        entries[i].type_count = (Uint16)level->type_count;
+        memcpy(data + offset, level->types, types_size);
+        memcpy(data + offset + types_size, level->cells, (size_t)level->rows * level->cols);
+        offset += types_size + (size_t)level->rows * level->cols;
+        offset = (offset + sizeof(Uint64) - 1) / sizeof(Uint64) * sizeof(Uint64);
+    }
+    memcpy(header->magic, "BUPK", 4);
+    header->version = LEVEL_PACK_VERSION;
+    header->level_count = (Uint32)level_count;
+    header->byte_order = LEVEL_PACK_BYTE_ORDER;
+    header->content_hash = fnv1a(0xCBF29CE484222325ull, data + sizeof(LevelPackHeader), size - sizeof(LevelPackHeader));
+
+    FILE* file = fopen(path, "wb");
+    bool ok = file != NULL && fwrite(data, 1, size, file) == size;
+    if (file != NULL && fclose(file) != 0) ok = false;
+    if (!ok) printf("Failed to write level pack: %s\n", path);
+    free(data);
+    return ok;
+}
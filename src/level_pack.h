@@ -0,0 +1,88 @@
+#ifndef BRICKED_UP_LEVEL_PACK_H
+#define BRICKED_UP_LEVEL_PACK_H
+
+// Level packs: a file of brick layouts that is memory-mapped and read in place, so
+// levels are never copied out of it. Opening reads it through once to check it.
+//
+// File layout (little endian, every struct at a multiple of its alignment):
+//   LevelPackHeader
+//   LevelPackEntry[level_count]
+//   per level, at its entry's offset: BrickType[type_count], then Uint8 cells[rows * cols]
+// Cells are row-major; 0 is an empty cell and k is a brick of types[k - 1]. Cells naming a
+// type past type_count are treated as empty. Opening checks content_hash and that every
+// level has at least one brick.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#define LEVEL_PACK_VERSION 1
+#define LEVEL_PACK_BYTE_ORDER 0x01020304u // read back as another value on a big-endian host
+#define MAX_BRICK_ROWS 256
+#define MAX_BRICK_COLS 256
+#define BRICK_SPRITE_ROWS 6 // brick colours in the spritesheet
+
+typedef struct {
+    char magic[4]; // "BUPK"
+    Uint32 version;
+    Uint32 level_count;
+    Uint32 byte_order;
+    Uint64 content_hash; // FNV-1a of everything after the header; identifies the pack in replays
+    Uint64 reserved;
+} LevelPackHeader;
+
+typedef struct {
+    Uint64 offset; // from the start of the file
+    Uint16 rows;
+    Uint16 cols;
+    Uint16 type_count;
+    Uint16 reserved;
+} LevelPackEntry;
+
+typedef struct {
+    Uint8 sprite_row; // below BRICK_SPRITE_ROWS
+    Uint8 hits; // hits to break, at least 1
+    Uint8 reserved[2];
+} BrickType;
+
+// A view of one level. For a mapped pack the pointers point into the mapping.
+typedef struct {
+    int rows;
+    int cols;
+    int type_count;
+    const BrickType* types;
+    const Uint8* cells;
+} Level;
+
+typedef struct {
+    const Uint8* data; // the whole file, or NULL for the built-in pack
+    size_t size;
+    int level_count;
+    Level* levels;
+    Uint64 content_hash;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+} LevelPack;
+
+// The classic 6 by 10 board, for running without a pack file.
+const LevelPack* level_pack_builtin(void);
+
+// Returns NULL, with a message printed, if the file can't be used. Reads the whole file.
+LevelPack* level_pack_open(const char* path);
+void level_pack_close(LevelPack* pack);
+
+// `index` wraps around, so play loops back to the first level after the last.
+const Level* level_pack_level(const LevelPack* pack, int index);
+
+// Asks the OS to start reading level `index` in the background, so laying it out later
+// doesn't stall on page faults.
+void level_pack_prefetch(const LevelPack* pack, int index);
+
+// Fills `cells` and `types` (room for rows * cols and BRICK_SPRITE_ROWS) with a generated
+// layout and points `level` at them.
+void level_generate(Level* level, Uint8* cells, BrickType* types, int rows, int cols, Uint64 seed);
+
+bool level_pack_write(const char* path, const Level* levels, int level_count);
+
+#endif
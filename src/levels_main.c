@@ -0,0 +1,38 @@
+// Level pack builder: writes the game's progression, from the classic board up to the
+// largest size a pack allows, as a pack the game maps at startup.
+#include "level_pack.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Rows and columns of each level, smallest first
+static const int level_sizes[][2] = {
+    {6, 10}, {8, 12}, {10, 16}, {14, 20}, {20, 30}, {30, 45},
+    {45, 70}, {70, 100}, {100, 150}, {150, 220}, {200, 256}, {256, 256},
+};
+
+#define LEVEL_COUNT ((int)SDL_arraysize(level_sizes))
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        printf("Usage: %s OUT\n", argv[0]);
+        return 1;
+    }
+
+    static Uint8 cells[LEVEL_COUNT][MAX_BRICK_ROWS * MAX_BRICK_COLS];
+    static BrickType types[LEVEL_COUNT][BRICK_SPRITE_ROWS];
+    Level levels[LEVEL_COUNT];
+    for (int i = 0; i < LEVEL_COUNT; i++) {
+        level_generate(&levels[i], cells[i], types[i], level_sizes[i][0], level_sizes[i][1], (Uint64)i);
+    }
+
+    // The first level is the classic board, so a new game starts the way it always has
+    for (int t = 0; t < BRICK_SPRITE_ROWS; t++) {
+        types[0][t].hits = 1;
+    }
+
+    if (!level_pack_write(argv[1], levels, LEVEL_COUNT)) {
+        return 1;
+    }
+    printf("Wrote %d levels to %s\n", LEVEL_COUNT, argv[1]);
+    return 0;
+}
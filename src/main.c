@@ -1,1122 +1,574 @@
 #include <SDL3/SDL.h>
 #include <SDL3_ttf/SDL_ttf.h>
-#include <SDL3_image/SDL_image.h>
 #include <stdbool.h>
-#include <math.h>
 #include <time.h>
 #include <stdio.h>
 #include <stdlib.h>
-
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
-#define PADDLE_WIDTH_INITIAL 80
-#define PADDLE_WIDTH_STEP 10
-#define PADDLE_HEIGHT 20
-#define BALL_SIZE 24
-#define BRICK_WIDTH 64
-#define BRICK_HEIGHT 32
-#define BRICK_ROWS 6
-#define BRICK_COLS 10
-#define TOP_MARGIN 70
-#define BORDER_THICKNESS 3
-#define POWERUP_SIZE 15
-#define MAX_POWERUPS 10
-#define POWERUP_SPAWN_COOLDOWN 250 // 0.25 seconds
-#define PADDLE_COLLISION_COOLDOWN 200 // 0.2 seconds
-#define MAX_BALLS 5
-#define PADDLE_SPEED 500.0f
-#define PADDLE_ACCELERATION 10.0f
-#define BALL_SPEED 350.0f
-#define POWERUP_SPEED 100.0f
-#define BRICK_ANIMATION_SPEED 50 // ms per frame
-#define MAX_PARTICLES 200
-
-typedef struct {
-    SDL_FPoint pos;
-    SDL_FPoint vel;
-    SDL_Color color;
-    float lifetime_ms;
-} Particle;
-
-
-typedef enum {
-    SCREEN_TITLE,
-    SCREEN_GAMEPLAY,
-    SCREEN_GAMEOVER
-} GameScreen;
-
-typedef enum {
-    POWERUP_ADD_LIFE,
-    POWERUP_REMOVE_LIFE,
-    POWERUP_PADDLE_WIDER,
-    POWERUP_PADDLE_NARROWER,
-    POWERUP_BALL_SPLIT,
-    POWERUP_STICKY_PADDLE
-} PowerUpType;
-
-typedef struct {
-    SDL_FRect rect;
-    bool active;
-    PowerUpType type;
-} PowerUp;
-
-typedef struct {
-    SDL_FRect rect;
-    float vel_x;
-    float vel_y;
-    bool active;
-    Uint64 last_collision_time;
-    bool is_stuck;
-    float stuck_offset_x;
-} Ball;
-
-typedef struct {
-    SDL_FRect rect;
-    bool active;
-    int animation_frame; // 0 = solid, 1-10 = animation
-    float animation_timer;
-} Brick;
-
-typedef struct {
-    SDL_Window* window;
-    SDL_Renderer* renderer;
-    TTF_Font* font;
-    SDL_Texture* spritesheet;
-    SDL_FRect paddle;
-    Brick bricks[BRICK_ROWS][BRICK_COLS];
-    PowerUp powerups[MAX_POWERUPS];
-    Ball balls[MAX_BALLS];
-    bool ball_launched;
-    bool left_pressed;
-    bool right_pressed;
-    int lives;
-    int paddle_size_level;
-    Uint64 last_powerup_spawn_time;
-    Uint64 sticky_paddle_timer_ms;
-    Particle particles[MAX_PARTICLES];
-    float force_field_y_offset;
-    float force_field_anim_timer;
-    bool quit;
-    bool paused;
-    Uint64 last_frame_time;
-    GameScreen current_screen;
-    bool debug_mode;
-    bool debug_render_collisions;
-    float game_speed;
-    Uint64 show_speed_timer;
-    float paddle_vel_x;
-} GameState;
-
-void launch_ball(Ball* ball, float paddle_x, float paddle_w) {
-    ball->is_stuck = false;
-    float ball_center_x = ball->rect.x + ball->rect.w / 2.0f;
-    float paddle_center_x = paddle_x + paddle_w / 2.0f;
-    
-    float diff = (ball_center_x - paddle_center_x) / (paddle_w / 2.0f);
-    
-    float angle = diff * (M_PI / 4.0f); // Max angle 45 degrees
-    
-    ball->vel_x = BALL_SPEED * sinf(angle);
-    ball->vel_y = -BALL_SPEED * cosf(angle);
+#include <string.h>
+#include "app.h"
+#include "assets.h"
+
+// Records inputs as advance_gameplay applies them, at the step they went in before.
+static void record_input(GameState* gs, Uint64 step, SimInput input, void* userdata) {
+    (void)gs;
+    replay_record_input(userdata, step, input);
 }
 
-void draw_filled_circle(SDL_Renderer* renderer, float center_x, float center_y, float radius) {
-    for (float y = -radius; y <= radius; y++) {
-        for (float x = -radius; x <= radius; x++) {
-            if (x * x + y * y <= radius * radius) {
-                SDL_RenderPoint(renderer, center_x + x, center_y + y);
-            }
-        }
+// A versus game steps both boards on this thread, one netplay frame per simulation step.
+// The seed is fixed, since both peers have to lay out the same boards.
+static void start_versus(App* app) {
+    netplay_destroy(app->netplay);
+    app->netplay = netplay_create(app->versus_player, app->net_socket, VERSUS_SEED,
+        app->level_pack != NULL ? app->level_pack : level_pack_builtin());
+    if (app->netplay == NULL) {
+        app->quit = true;
+        return;
     }
+    app->view = netplay_board(app->netplay, app->versus_player);
+    app->versus_input = 0;
+    app->versus_next_ns = SDL_GetTicksNS();
 }
 
-void draw_rounded_rect(SDL_Renderer* renderer, SDL_FRect* rect, float radius) {
-    float x = rect->x;
-    float y = rect->y;
-    float w = rect->w;
-    float h = rect->h;
-
-    SDL_FRect body = {x + radius, y, w - 2 * radius, h};
-    SDL_RenderFillRect(renderer, &body);
-    SDL_FRect body2 = {x, y + radius, w, h - 2 * radius};
-    SDL_RenderFillRect(renderer, &body2);
-
-    draw_filled_circle(renderer, x + radius, y + radius, radius);
-    draw_filled_circle(renderer, x + w - radius, y + radius, radius);
-    draw_filled_circle(renderer, x + radius, y + h - radius, radius);
-    draw_filled_circle(renderer, x + w - radius, y + h - radius, radius);
-}
+void start_game(App* app, Uint64 seed) {
+    app->current_screen = SCREEN_GAMEPLAY;
+    app->debug_mode = false;
+    app->debug_render_collisions = false;
+    app->show_speed_timer_ns = 0;
+    sim_start_game(&app->gs, seed, app->level_pack);
+    app->gs.chaos = app->chaos;
+    particles_clear(app->particles);
+    app->gs.particles = app->particles;
+    app->gs.jobs = app->jobs;
+    sim_clock_init(&app->clock, sim_wall_clock, NULL);
+    app->game_speed = app->gs.game_speed;
+    app->last_frame_ns = SDL_GetTicksNS();
+    app->shown_steps = 0;
+    bot_init(&app->bot);
+    if (app->versus_player >= 0) {
+        start_versus(app);
+        return;
+    }
 
-void initialize_powerups(GameState* gs) {
-    for (int i = 0; i < MAX_POWERUPS; i++) {
-        gs->powerups[i].active = false;
+    if (app->record_path != NULL) {
+        app->replay = replay_create(app->record_path, seed, app->gs.levels->content_hash, app->chaos ? REPLAY_FLAG_CHAOS : 0);
+        app->record_path = NULL;
+    }
+    if (app->replay != NULL) {
+        app->clock.before_step = replay_before_step;
+        app->clock.step_userdata = app->replay;
+        if (!app->playing_replay) {
+            app->clock.on_input = record_input;
+            app->clock.input_userdata = app->replay;
+        }
+    }
+    // From here the thread steps the game; this thread only draws its snapshots
+    // Rewinding would rewrite the history a replay records or plays back
+    RewindBuffer* rewind = app->replay == NULL ? app->rewind : NULL;
+    if (!sim_thread_start(app->sim, &app->gs, &app->clock, app->playing_replay ? app->replay : NULL, rewind)) {
+        app->quit = true;
     }
+    app->view = &sim_thread_latest(app->sim)->gs;
 }
 
-void spawn_powerup(GameState* gs, float x, float y) {
-    Uint64 current_time = SDL_GetTicks();
-    if (current_time - gs->last_powerup_spawn_time < POWERUP_SPAWN_COOLDOWN) {
+// Gameplay inputs from the keyboard, queued with the event's timestamp so they go in at
+// the step nearest to when the key moved. During playback they come from the replay instead.
+void gameplay_input(App* app, SimInput input, Uint64 time_ns) {
+    if (app->playing_replay) return;
+    if (app->netplay != NULL) {
+        // Netplay sends held keys once a frame rather than timed events
+        switch (input) {
+            case SIM_INPUT_LEFT_DOWN: app->versus_input |= NETPLAY_INPUT_LEFT; break;
+            case SIM_INPUT_LEFT_UP: app->versus_input &= ~NETPLAY_INPUT_LEFT; break;
+            case SIM_INPUT_RIGHT_DOWN: app->versus_input |= NETPLAY_INPUT_RIGHT; break;
+            case SIM_INPUT_RIGHT_UP: app->versus_input &= ~NETPLAY_INPUT_RIGHT; break;
+            case SIM_INPUT_LAUNCH: app->versus_input |= NETPLAY_INPUT_LAUNCH; break;
+            default: break; // no pausing a game someone else is playing too
+        }
+        if (app->unshown_input_ns == 0) {
+            app->unshown_input_ns = time_ns;
+        }
         return;
     }
 
-    int rand_val = rand() % 100;
-    PowerUpType type;
-
-    if (rand_val < 5) {
-        type = POWERUP_BALL_SPLIT;
-    } else if (rand_val < 10) {
-        type = POWERUP_STICKY_PADDLE;
-    } else if (rand_val < 20) {
-        type = POWERUP_ADD_LIFE;
-    } else if (rand_val < 35) {
-        type = POWERUP_PADDLE_WIDER;
-    } else if (rand_val < 50) {
-        type = POWERUP_REMOVE_LIFE;
-    } else if (rand_val < 75) {
-        type = POWERUP_PADDLE_NARROWER;
-    } else {
-        return;
+    sim_thread_post(app->sim, (SimCommand){ .type = SIM_COMMAND_INPUT, .input = input, .time_ns = time_ns });
+    if (app->unshown_input_ns == 0) {
+        app->unshown_input_ns = time_ns;
     }
+}
 
-    for (int i = 0; i < MAX_POWERUPS; i++) {
-        if (!gs->powerups[i].active) {
-            gs->powerups[i].active = true;
-            gs->powerups[i].rect.x = x;
-            gs->powerups[i].rect.y = y;
-            gs->powerups[i].rect.w = POWERUP_SIZE;
-            gs->powerups[i].rect.h = POWERUP_SIZE;
-            gs->powerups[i].type = type;
-            gs->last_powerup_spawn_time = current_time;
-            break;
+void finish_replay(App* app) {
+    if (app->replay == NULL) return;
+
+    if (app->playing_replay) {
+        if (replay_diverged(app->replay)) {
+            printf("Replay diverged at step %llu\n", (unsigned long long)replay_divergence_step(app->replay));
+        } else {
+            printf("Replay matched the recording (%llu steps)\n", (unsigned long long)app->clock.steps);
         }
     }
+    replay_close(app->replay, &app->gs, app->clock.steps);
+    app->replay = NULL;
+    app->playing_replay = false;
+    app->clock.before_step = NULL;
+    app->clock.step_userdata = NULL;
+    app->clock.on_input = NULL;
+    app->clock.input_userdata = NULL;
 }
 
-void reset_ball(GameState* gs) {
-    gs->ball_launched = false;
-    for (int i = 0; i < MAX_BALLS; i++) {
-        gs->balls[i].active = false;
-        gs->balls[i].is_stuck = false;
+// The bot looks at what is on screen and presses keys through the same path as the player
+static void bot_input(App* app) {
+    if (!app->bot_playing) return;
+
+    SimInput inputs[BOT_MAX_INPUTS];
+    int count = bot_update(&app->bot, app->view, inputs);
+    Uint64 now_ns = SDL_GetTicksNS();
+    for (int i = 0; i < count; i++) {
+        gameplay_input(app, inputs[i], now_ns);
     }
-    gs->balls[0].active = true;
-    gs->balls[0].vel_x = 0;
-    gs->balls[0].vel_y = 0;
-    gs->balls[0].rect.w = BALL_SIZE;
-    gs->balls[0].rect.h = BALL_SIZE;
-    gs->balls[0].rect.x = gs->paddle.x + (gs->paddle.w / 2) - (BALL_SIZE / 2);
-    gs->balls[0].rect.y = gs->paddle.y - BALL_SIZE;
-    gs->balls[0].last_collision_time = 0;
-    initialize_powerups(gs);
 }
 
-void reset_game(GameState* gs) {
-    gs->lives = 3;
-    gs->paddle_size_level = 0;
-    gs->paddle.w = PADDLE_WIDTH_INITIAL;
-    gs->paddle.x = (SCREEN_WIDTH - gs->paddle.w) / 2;
-    gs->paddle.y = SCREEN_HEIGHT - PADDLE_HEIGHT - 10;
-    gs->paddle.h = PADDLE_HEIGHT;
-    gs->sticky_paddle_timer_ms = 0;
-    gs->force_field_y_offset = 0;
-    gs->force_field_anim_timer = 0;
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        gs->particles[i].lifetime_ms = 0;
+// Runs the netplay frames that are due. When the peer falls behind, netplay_advance waits
+// on it and the frames that didn't run are let go rather than caught up in a burst.
+static void update_versus(App* app) {
+    Uint64 now_ns = SDL_GetTicksNS();
+    int frames = 0;
+    while (app->versus_next_ns <= now_ns && frames < NETPLAY_MAX_PREDICTION) {
+        if (!netplay_advance(app->netplay, app->versus_input)) {
+            app->versus_next_ns = now_ns;
+            break;
+        }
+        app->versus_input &= ~NETPLAY_INPUT_LAUNCH;
+        app->versus_next_ns += SIM_STEP_NS;
+        frames++;
     }
-    gs->paused = false;
-    gs->left_pressed = false;
-    gs->right_pressed = false;
-    gs->debug_mode = false;
-    gs->debug_render_collisions = false;
-    gs->game_speed = 1.0f;
-    gs->show_speed_timer = 0;
-    gs->paddle_vel_x = 0.0f;
+    if (frames == 0) {
+        netplay_poll(app->netplay);
+    }
+    if (app->versus_next_ns + NETPLAY_MAX_PREDICTION * SIM_STEP_NS < now_ns) {
+        app->versus_next_ns = now_ns;
+    }
+    app->frame_stats.current.steps = frames;
 
-    float total_bricks_width = BRICK_COLS * (BRICK_WIDTH + 11) - 11;
-    float side_margin = (SCREEN_WIDTH - total_bricks_width) / 2.0f;
-    for (int i = 0; i < BRICK_ROWS; i++) {
-        for (int j = 0; j < BRICK_COLS; j++) {
-            gs->bricks[i][j].active = true;
-            gs->bricks[i][j].animation_frame = 0;
-            gs->bricks[i][j].animation_timer = 0;
-            gs->bricks[i][j].rect.w = BRICK_WIDTH;
-            gs->bricks[i][j].rect.h = BRICK_HEIGHT;
-            gs->bricks[i][j].rect.x = side_margin + j * (BRICK_WIDTH + 11);
-            gs->bricks[i][j].rect.y = i * (BRICK_HEIGHT + 11) + 35 + TOP_MARGIN;
-        }
+    NetplayResult result = netplay_result(app->netplay);
+    if (result != NETPLAY_PLAYING) {
+        NetplayStats stats = netplay_stats(app->netplay);
+        printf("%s after %d frames (%llu rollbacks, %llu stalls)\n", result == NETPLAY_DRAW ? "Draw" :
+            result == (app->versus_player == 0 ? NETPLAY_WON_BY_0 : NETPLAY_WON_BY_1) ? "Won" : "Lost",
+            netplay_frame(app->netplay), (unsigned long long)stats.rollbacks, (unsigned long long)stats.stalls);
+        app->current_screen = SCREEN_GAMEOVER;
     }
+}
 
-    reset_ball(gs);
+static void set_game_speed(App* app, float speed) {
+    app->game_speed = speed;
+    app->show_speed_timer_ns = SDL_MS_TO_NS(2000);
+    sim_thread_post(app->sim, (SimCommand){ .type = SIM_COMMAND_SET_SPEED, .speed = speed });
 }
 
-void handle_events_gameplay(GameState* gs) {
+void handle_events_gameplay(App* app) {
     SDL_Event e;
     while (SDL_PollEvent(&e) != 0) {
         if (e.type == SDL_EVENT_QUIT) {
-            gs->quit = true;
+            app->quit = true;
+        }
+        if (e.type == SDL_EVENT_RENDER_TARGETS_RESET || e.type == SDL_EVENT_RENDER_DEVICE_RESET) {
+            render_invalidate_layers(app);
         }
         if (e.type == SDL_EVENT_KEY_DOWN) {
             switch (e.key.key) {
                 case SDLK_P:
-                    gs->paused = !gs->paused;
+                    gameplay_input(app, SIM_INPUT_PAUSE, e.key.timestamp);
                     break;
                 case SDLK_LEFT:
-                    gs->left_pressed = true;
+                    gameplay_input(app, SIM_INPUT_LEFT_DOWN, e.key.timestamp);
                     break;
                 case SDLK_RIGHT:
-                    gs->right_pressed = true;
+                    gameplay_input(app, SIM_INPUT_RIGHT_DOWN, e.key.timestamp);
                     break;
                 case SDLK_SPACE:
-                    if (!gs->paused) {
-                        if (!gs->ball_launched) {
-                            gs->ball_launched = true;
-                            launch_ball(&gs->balls[0], gs->paddle.x, gs->paddle.w);
-                        } else {
-                            for (int i = 0; i < MAX_BALLS; i++) {
-                                if (gs->balls[i].active && gs->balls[i].is_stuck) {
-                                    launch_ball(&gs->balls[i], gs->paddle.x, gs->paddle.w);
-                                }
-                            }
-                        }
-                    }
+                    gameplay_input(app, SIM_INPUT_LAUNCH, e.key.timestamp);
+                    break;
+                case SDLK_BACKSPACE:
+                    sim_thread_post(app->sim, (SimCommand){ .type = SIM_COMMAND_REWIND, .rewinding = true });
                     break;
                 case SDLK_D:
-                    gs->debug_mode = !gs->debug_mode;
+                    app->debug_mode = !app->debug_mode;
                     break;
                 case SDLK_C:
-                    if (gs->debug_mode) {
-                        gs->debug_render_collisions = !gs->debug_render_collisions;
+                    if (app->debug_mode) {
+                        app->debug_render_collisions = !app->debug_render_collisions;
                     }
                     break;
                 case SDLK_S:
-                    if (gs->debug_mode) {
-                        gs->game_speed -= 0.1f;
-                        if (gs->game_speed < 0.1f) gs->game_speed = 0.1f;
-                        gs->show_speed_timer = 2000;
+                    if (app->debug_mode) {
+                        set_game_speed(app, SDL_max(app->game_speed - 0.1f, 0.1f));
                     }
                     break;
                 case SDLK_F:
-                    if (gs->debug_mode) {
-                        gs->game_speed += 0.1f;
-                        gs->show_speed_timer = 2000;
+                    if (app->debug_mode) {
+                        set_game_speed(app, app->game_speed + 0.1f);
                     }
                     break;
                 case SDLK_R:
-                    if (gs->debug_mode) {
-                        gs->game_speed = 1.0f;
-                        gs->show_speed_timer = 2000;
+                    if (app->debug_mode) {
+                        set_game_speed(app, 1.0f);
                     }
                     break;
             }
         }
         if (e.type == SDL_EVENT_KEY_UP) {
             switch (e.key.key) {
+                case SDLK_BACKSPACE:
+                    sim_thread_post(app->sim, (SimCommand){ .type = SIM_COMMAND_REWIND, .rewinding = false });
+                    break;
                 case SDLK_LEFT:
-                    gs->left_pressed = false;
+                    gameplay_input(app, SIM_INPUT_LEFT_UP, e.key.timestamp);
                     break;
                 case SDLK_RIGHT:
-                    gs->right_pressed = false;
+                    gameplay_input(app, SIM_INPUT_RIGHT_UP, e.key.timestamp);
                     break;
             }
         }
     }
 }
 
-void handle_events_title(GameState* gs) {
+static Uint64 fresh_seed(void) {
+    return ((Uint64)time(NULL) << 32) ^ SDL_GetTicksNS();
+}
+
+void handle_events_title(App* app) {
     SDL_Event e;
     while (SDL_PollEvent(&e) != 0) {
         if (e.type == SDL_EVENT_QUIT) {
-            gs->quit = true;
+            app->quit = true;
+        }
+        if (e.type == SDL_EVENT_RENDER_TARGETS_RESET || e.type == SDL_EVENT_RENDER_DEVICE_RESET) {
+            render_invalidate_layers(app);
         }
         if (e.type == SDL_EVENT_KEY_DOWN) {
             if (e.key.key == SDLK_RETURN) {
-                gs->current_screen = SCREEN_GAMEPLAY;
-                reset_game(gs);
+                if (app->assets_ready) {
+                    start_game(app, fresh_seed());
+                } else {
+                    app->start_requested = true;
+                }
             }
         }
     }
 }
 
-void handle_events_gameover(GameState* gs) {
+void handle_events_gameover(App* app) {
     SDL_Event e;
     while (SDL_PollEvent(&e) != 0) {
         if (e.type == SDL_EVENT_QUIT) {
-            gs->quit = true;
+            app->quit = true;
+        }
+        if (e.type == SDL_EVENT_RENDER_TARGETS_RESET || e.type == SDL_EVENT_RENDER_DEVICE_RESET) {
+            render_invalidate_layers(app);
         }
         if (e.type == SDL_EVENT_KEY_DOWN) {
             if (e.key.key == SDLK_RETURN) {
-                gs->current_screen = SCREEN_TITLE;
+                // The peers would have to agree on a rematch; one versus game per run
+                if (app->netplay != NULL) {
+                    app->quit = true;
+                } else {
+                    app->current_screen = SCREEN_TITLE;
+                }
             }
         }
     }
 }
 
 
-float swept_aabb(SDL_FRect b1, SDL_FPoint vel, SDL_FRect b2, float* normal_x, float* normal_y) {
-    float inv_entry_x, inv_entry_y;
-    float inv_exit_x, inv_exit_y;
-
-    if (vel.x > 0.0f) {
-        inv_entry_x = b2.x - (b1.x + b1.w);
-        inv_exit_x = (b2.x + b2.w) - b1.x;
-    } else {
-        inv_entry_x = (b2.x + b2.w) - b1.x;
-        inv_exit_x = b2.x - (b1.x + b1.w);
-    }
-
-    if (vel.y > 0.0f) {
-        inv_entry_y = b2.y - (b1.y + b1.h);
-        inv_exit_y = (b2.y + b2.h) - b1.y;
-    } else {
-        inv_entry_y = (b2.y + b2.h) - b1.y;
-        inv_exit_y = b2.y - (b1.y + b1.h);
-    }
-
-    float entry_x, entry_y;
-    float exit_x, exit_y;
-
-    if (vel.x == 0.0f) {
-        if (b1.x + b1.w < b2.x || b1.x > b2.x + b2.w) {
-            *normal_x = 0.0f;
-            *normal_y = 0.0f;
-            return 1.0f;
-        }
-        entry_x = -INFINITY;
-        exit_x = INFINITY;
-    } else {
-        entry_x = inv_entry_x / vel.x;
-        exit_x = inv_exit_x / vel.x;
-    }
-
-    if (vel.y == 0.0f) {
-        if (b1.y + b1.h < b2.y || b1.y > b2.y + b2.h) {
-            *normal_x = 0.0f;
-            *normal_y = 0.0f;
-            return 1.0f;
-        }
-        entry_y = -INFINITY;
-        exit_y = INFINITY;
-    } else {
-        entry_y = inv_entry_y / vel.y;
-        exit_y = inv_exit_y / vel.y;
-    }
-
-    float entry_time = fmaxf(entry_x, entry_y);
-    float exit_time = fminf(exit_x, exit_y);
-
-    if (entry_time > exit_time || entry_x < 0.0f && entry_y < 0.0f || entry_x > 1.0f || entry_y > 1.0f) {
-        *normal_x = 0.0f;
-        *normal_y = 0.0f;
-        return 1.0f;
-    }
-
-    if (entry_x > entry_y) {
-        *normal_x = (vel.x > 0.0f) ? -1.0f : 1.0f;
-        *normal_y = 0.0f;
-    } else {
-        *normal_x = 0.0f;
-        *normal_y = (vel.y > 0.0f) ? -1.0f : 1.0f;
-    }
+#define DEFAULT_LEVEL_PACK "assets/levels.bupk"
 
-    return entry_time;
+// Moves whatever the loader produced into the app, waiting for it if it's still running
+static bool take_loaded_assets(App* app) {
+    bool ok = asset_loader_join(&app->loader);
+    app->font = app->loader.font;
+    app->text = app->loader.text;
+    app->level_pack = app->loader.level_pack;
+    memset(&app->loader, 0, sizeof(AssetLoader));
+    return ok;
 }
 
-void update_gameplay(GameState* gs, Uint64 unscaled_delta_ms) {
-    if (gs->paused) return;
-
-    if (gs->show_speed_timer > 0) {
-        if (unscaled_delta_ms >= gs->show_speed_timer) {
-            gs->show_speed_timer = 0;
-        } else {
-            gs->show_speed_timer -= unscaled_delta_ms;
-        }
-    }
-
-    Uint64 delta_ms = unscaled_delta_ms * gs->game_speed;
-    float delta_seconds = delta_ms / 1000.0f;
-
-    float target_vel_x = 0.0f;
-    if (gs->left_pressed && !gs->right_pressed) {
-        target_vel_x = -PADDLE_SPEED;
-    } else if (gs->right_pressed && !gs->left_pressed) {
-        target_vel_x = PADDLE_SPEED;
-    }
-
-    if (target_vel_x != 0) {
-        gs->paddle_vel_x += (target_vel_x - gs->paddle_vel_x) * PADDLE_ACCELERATION * delta_seconds;
-    } else {
-        gs->paddle_vel_x = 0;
+// Uploads the loaded assets, then starts the game that was waiting on them, if any
+static bool finish_loading(App* app) {
+    if (!take_loaded_assets(app)) {
+        return false;
     }
-
-    gs->paddle.x += gs->paddle_vel_x * delta_seconds;
-
-    if (gs->paddle.x < BORDER_THICKNESS) {
-        gs->paddle.x = BORDER_THICKNESS;
+    app->spritesheet = assets_load_spritesheet(app->renderer);
+    if (app->spritesheet == NULL) {
+        printf("Failed to load spritesheet: %s\n", SDL_GetError());
+        return false;
     }
-    if (gs->paddle.x > SCREEN_WIDTH - gs->paddle.w - BORDER_THICKNESS) {
-        gs->paddle.x = SCREEN_WIDTH - gs->paddle.w - BORDER_THICKNESS;
+    SDL_SetTextureScaleMode(app->spritesheet, SDL_SCALEMODE_NEAREST);
+    if (!render_attach_assets(app)) {
+        return false;
     }
+    app->assets_ready = true;
 
-    bool is_sticky_paddle_active = gs->sticky_paddle_timer_ms > 0;
-
-    for (int k = 0; k < MAX_BALLS; k++) {
-        if (!gs->balls[k].active) continue;
-        if (gs->balls[k].is_stuck) {
-            gs->balls[k].rect.x = gs->paddle.x + gs->balls[k].stuck_offset_x;
-            gs->balls[k].rect.y = gs->paddle.y - BALL_SIZE;
-            continue;
+    if (app->playing_replay) {
+        const LevelPack* levels = app->level_pack != NULL ? app->level_pack : level_pack_builtin();
+        if (replay_levels_hash(app->replay) != levels->content_hash) {
+            printf("Replay was recorded on a different level pack\n");
+            return false;
         }
+        app->record_path = NULL;
+        app->chaos = (replay_flags(app->replay) & REPLAY_FLAG_CHAOS) != 0;
+        start_game(app, replay_seed(app->replay));
+    } else if (app->start_requested) {
+        start_game(app, fresh_seed());
+    }
+    app->start_requested = false;
+    return true;
+}
 
-        if (gs->ball_launched) {
-            float remaining_time = delta_seconds;
-            
-            while (remaining_time > 0.00001f) {
-                float min_collision_time = remaining_time;
-                float combined_normal_x = 0.0f, combined_normal_y = 0.0f;
-                int num_collisions = 0;
-
-                Brick* colliding_bricks[BRICK_ROWS * BRICK_COLS] = {NULL};
-                int num_colliding_bricks = 0;
-                bool paddle_collided = false;
-
-                SDL_FPoint vel = {gs->balls[k].vel_x, gs->balls[k].vel_y};
-
-                // Brick collision
-                for (int i = 0; i < BRICK_ROWS; i++) {
-                    for (int j = 0; j < BRICK_COLS; j++) {
-                        if (gs->bricks[i][j].active && gs->bricks[i][j].animation_frame == 0) {
-                            float nx, ny;
-                            float t = swept_aabb(gs->balls[k].rect, vel, gs->bricks[i][j].rect, &nx, &ny);
-                            if (t < min_collision_time) {
-                                min_collision_time = t;
-                                combined_normal_x = nx;
-                                combined_normal_y = ny;
-                                num_collisions = 1;
-                                paddle_collided = false;
-                                num_colliding_bricks = 1;
-                                colliding_bricks[0] = &gs->bricks[i][j];
-                            } else if (t == min_collision_time) {
-                                combined_normal_x += nx;
-                                combined_normal_y += ny;
-                                num_collisions++;
-                                colliding_bricks[num_colliding_bricks++] = &gs->bricks[i][j];
-                            }
-                        }
-                    }
-                }
-
-                // Paddle collision
-                if (SDL_GetTicks() - gs->balls[k].last_collision_time > PADDLE_COLLISION_COOLDOWN) {
-                    float nx, ny;
-                    float t = swept_aabb(gs->balls[k].rect, vel, gs->paddle, &nx, &ny);
-                    if (t < min_collision_time) {
-                        min_collision_time = t;
-                        num_collisions = 1;
-                        paddle_collided = true;
-                        num_colliding_bricks = 0;
-                    } else if (t == min_collision_time) {
-                        paddle_collided = true;
-                        num_collisions++;
-                    }
-                }
-
-                // Wall collisions
-                SDL_FRect walls[] = {
-                    {0, TOP_MARGIN - 10, SCREEN_WIDTH, 10}, // Top
-                    {BORDER_THICKNESS - 10, 0, 10, SCREEN_HEIGHT}, // Left
-                    {SCREEN_WIDTH - BORDER_THICKNESS, 0, 10, SCREEN_HEIGHT} // Right
-                };
-                for (int i = 0; i < 3; i++) {
-                    float nx, ny;
-                    float t = swept_aabb(gs->balls[k].rect, vel, walls[i], &nx, &ny);
-                    if (t < min_collision_time) {
-                        min_collision_time = t;
-                        combined_normal_x = nx;
-                        combined_normal_y = ny;
-                        num_collisions = 1;
-                        paddle_collided = false;
-                        num_colliding_bricks = 0;
-                    } else if (t == min_collision_time) {
-                        combined_normal_x += nx;
-                        combined_normal_y += ny;
-                        num_collisions++;
-                    }
-                }
-
-                gs->balls[k].rect.x += gs->balls[k].vel_x * min_collision_time;
-                gs->balls[k].rect.y += gs->balls[k].vel_y * min_collision_time;
-                
-                if (num_collisions > 0) {
-                    if (paddle_collided) {
-                        gs->balls[k].last_collision_time = SDL_GetTicks();
-                        if (is_sticky_paddle_active) {
-                            gs->balls[k].is_stuck = true;
-                            gs->balls[k].stuck_offset_x = gs->balls[k].rect.x - gs->paddle.x;
-                            gs->balls[k].vel_x = 0;
-                            gs->balls[k].vel_y = 0;
-                            break; 
-                        } else {
-                            launch_ball(&gs->balls[k], gs->paddle.x, gs->paddle.w);
-                        }
-                    } else {
-                        for (int i = 0; i < num_colliding_bricks; i++) {
-                            Brick* brick = colliding_bricks[i];
-                            if (brick && brick->animation_frame == 0) {
-                                brick->animation_frame = 1;
-                                brick->animation_timer = 0;
-                                spawn_powerup(gs, brick->rect.x + (BRICK_WIDTH / 2) - (POWERUP_SIZE / 2), brick->rect.y + (BRICK_HEIGHT / 2) - (POWERUP_SIZE / 2));
-                            }
-                        }
+static bool file_exists(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return false;
+    fclose(file);
+    return true;
+}
 
-                        float magnitude = sqrtf(combined_normal_x * combined_normal_x + combined_normal_y * combined_normal_y);
-                        if (magnitude > 0.0f) {
-                            float normalized_x = combined_normal_x / magnitude;
-                            float normalized_y = combined_normal_y / magnitude;
-                            
-                            float dot_product = gs->balls[k].vel_x * normalized_x + gs->balls[k].vel_y * normalized_y;
-                            gs->balls[k].vel_x -= 2 * dot_product * normalized_x;
-                            gs->balls[k].vel_y -= 2 * dot_product * normalized_y;
-                        }
-                    }
-                }
-                
-                remaining_time -= min_collision_time;
-            }
-        }
+int main(int argc, char* argv[]) {
+    SDL_Init(SDL_INIT_VIDEO);
+    TTF_Init();
 
-        if (gs->balls[k].rect.y > SCREEN_HEIGHT) {
-            gs->balls[k].active = false;
-            int active_balls = 0;
-            for (int l = 0; l < MAX_BALLS; l++) {
-                if (gs->balls[l].active) active_balls++;
-            }
-            if (active_balls == 0) {
-                gs->lives--;
-                if (gs->lives <= 0) {
-                    gs->current_screen = SCREEN_GAMEOVER;
-                } else {
-                    reset_ball(gs);
-                }
-            }
-        }
-    }
+    // Static: the GameState holds a board of the largest size, too big for the stack
+    static App app;
+    app.window = SDL_CreateWindow("Bricked Up", SCREEN_WIDTH, SCREEN_HEIGHT, 0);
+    app.renderer = SDL_CreateRenderer(app.window, NULL);
 
-    bool all_bricks_destroyed = true;
-    for (int i = 0; i < BRICK_ROWS; i++) {
-        for (int j = 0; j < BRICK_COLS; j++) {
-            if (gs->bricks[i][j].active) {
-                all_bricks_destroyed = false;
-                break;
-            }
-        }
-        if (!all_bricks_destroyed) break;
+    // The font, spritesheet and level pack load in the background (see finish_loading),
+    // so this is all that runs before the first frame
+    if (!render_init(&app)) {
+        return 1;
     }
 
-    if (all_bricks_destroyed) {
-        reset_game(gs);
+    // The simulation thread joins in as worker 0 while it waits on a step, so one thread fewer than cores
+    app.jobs = job_pool_create(SDL_GetNumLogicalCPUCores() - 1);
+    app.sim = sim_thread_create();
+    if (app.sim == NULL) {
+        printf("Failed to create simulation thread\n");
+        return 1;
     }
-
-    if (!gs->ball_launched) {
-        gs->balls[0].rect.x = gs->paddle.x + (gs->paddle.w / 2) - (BALL_SIZE / 2);
-        gs->balls[0].rect.y = gs->paddle.y - BALL_SIZE;
+    app.rewind = rewind_create(REWIND_BUFFER_BYTES, REWIND_SECONDS * (int)(SDL_NS_PER_SECOND / SIM_STEP_NS), REWIND_KEYFRAME_INTERVAL);
+    if (app.rewind == NULL) {
+        return 1;
     }
 
-    // Update powerups
-    for (int i = 0; i < MAX_POWERUPS; i++) {
-        if (gs->powerups[i].active) {
-            gs->powerups[i].rect.y += POWERUP_SPEED * delta_seconds;
-            if (SDL_HasRectIntersectionFloat(&gs->powerups[i].rect, &gs->paddle)) {
-                gs->powerups[i].active = false;
-                if (gs->powerups[i].type == POWERUP_ADD_LIFE) {
-                    gs->lives++;
-                } else if (gs->powerups[i].type == POWERUP_REMOVE_LIFE) {
-                    gs->lives--;
-                } else if (gs->powerups[i].type == POWERUP_PADDLE_WIDER) {
-                    if (gs->paddle_size_level < 3) {
-                        gs->paddle_size_level++;
-                    }
-                } else if (gs->powerups[i].type == POWERUP_PADDLE_NARROWER) {
-                    if (gs->paddle_size_level > -3) {
-                        gs->paddle_size_level--;
-                    }
-                } else if (gs->powerups[i].type == POWERUP_STICKY_PADDLE) {
-                    gs->sticky_paddle_timer_ms = 15000;
-                } else if (gs->powerups[i].type == POWERUP_BALL_SPLIT) {
-                    int first_active_ball = -1;
-                    for (int l = 0; l < MAX_BALLS; l++) {
-                        if (gs->balls[l].active && !gs->balls[l].is_stuck) {
-                            first_active_ball = l;
-                            break;
-                        }
-                    }
-
-                    if (first_active_ball != -1) {
-                        for (int l = 0; l < MAX_BALLS; l++) {
-                            if (!gs->balls[l].active) {
-                                gs->balls[l] = gs->balls[first_active_ball];
-                                gs->balls[l].vel_x = -gs->balls[first_active_ball].vel_x;
-                                break;
-                            }
-                        }
-                    }
-                }
-
-                float old_width = gs->paddle.w;
-                gs->paddle.w = PADDLE_WIDTH_INITIAL + gs->paddle_size_level * PADDLE_WIDTH_STEP;
-                gs->paddle.x -= (gs->paddle.w - old_width) / 2;
-
-            } else if (gs->powerups[i].rect.y > SCREEN_HEIGHT) {
-                gs->powerups[i].active = false;
+    app.level_pack = NULL;
+    app.chaos = false;
+    sim_start_game(&app.gs, (Uint64)time(NULL), NULL);
+    app.gs.particles = app.particles;
+    app.gs.jobs = app.jobs;
+    app.view = &app.gs;
+
+    app.quit = false;
+    app.debug_mode = false;
+    app.debug_render_collisions = false;
+    app.show_speed_timer_ns = 0;
+    app.current_screen = SCREEN_TITLE;
+    app.record_path = NULL;
+    app.replay = NULL;
+    app.playing_replay = false;
+    app.unshown_input_ns = 0;
+    app.versus_player = -1;
+    sim_clock_init(&app.clock, sim_wall_clock, NULL);
+    frame_stats_init(&app.frame_stats);
+    PacingMode pacing = PACING_VSYNC;
+    float target_hz = 0.0f;
+    const char* levels_path = NULL;
+    int port = 0;
+    int peer_port = 0;
+    const char* peer_host = "127.0.0.1";
+    NetConditions conditions = {0};
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            app.record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            app.replay = replay_open(argv[++i]);
+            if (app.replay == NULL) {
+                return 1;
             }
-        }
-    }
-
-    // Update brick animations
-    for (int i = 0; i < BRICK_ROWS; i++) {
-        for (int j = 0; j < BRICK_COLS; j++) {
-            if (gs->bricks[i][j].active && gs->bricks[i][j].animation_frame > 0) {
-                gs->bricks[i][j].animation_timer += delta_ms;
-                if (gs->bricks[i][j].animation_timer > BRICK_ANIMATION_SPEED) {
-                    gs->bricks[i][j].animation_frame++;
-                    gs->bricks[i][j].animation_timer -= BRICK_ANIMATION_SPEED;
-                    if (gs->bricks[i][j].animation_frame > 10) {
-                        gs->bricks[i][j].active = false;
-                    }
-                }
+            app.playing_replay = true;
+        } else if (strcmp(argv[i], "--frame-log") == 0 && i + 1 < argc) {
+            if (!frame_stats_open_log(&app.frame_stats, argv[++i])) {
+                return 1;
             }
-        }
-    }
-    
-    if (gs->sticky_paddle_timer_ms > 0) {
-        if (unscaled_delta_ms >= gs->sticky_paddle_timer_ms) {
-            gs->sticky_paddle_timer_ms = 0;
+        } else if (strcmp(argv[i], "--vsync") == 0) {
+            pacing = PACING_VSYNC;
+        } else if (strcmp(argv[i], "--limit") == 0) {
+            pacing = PACING_LIMIT;
+        } else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            pacing = PACING_LIMIT;
+            target_hz = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--uncapped") == 0) {
+            pacing = PACING_UNCAPPED;
+        } else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) {
+            levels_path = argv[++i];
+        } else if (strcmp(argv[i], "--chaos") == 0) {
+            app.chaos = true;
+        } else if (strcmp(argv[i], "--bot") == 0) {
+            app.bot_playing = true;
+        } else if (strcmp(argv[i], "--versus") == 0 && i + 1 < argc) {
+            app.versus_player = atoi(argv[++i]) != 0;
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--peer-port") == 0 && i + 1 < argc) {
+            peer_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--peer") == 0 && i + 1 < argc) {
+            peer_host = argv[++i];
+        } else if (strcmp(argv[i], "--latency-ms") == 0 && i + 1 < argc) {
+            conditions.latency_ms = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--jitter-ms") == 0 && i + 1 < argc) {
+            conditions.jitter_ms = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--loss") == 0 && i + 1 < argc) {
+            conditions.loss = (float)atof(argv[++i]) / 100.0f;
         } else {
-            gs->sticky_paddle_timer_ms -= unscaled_delta_ms;
-        }
-
-        if (gs->sticky_paddle_timer_ms == 0) {
-            for (int i = 0; i < MAX_BALLS; i++) {
-                if (gs->balls[i].active && gs->balls[i].is_stuck) {
-                    launch_ball(&gs->balls[i], gs->paddle.x, gs->paddle.w);
-                }
-            }
-        }
-    }
-
-    // Update force field animation
-    if (is_sticky_paddle_active) {
-        gs->force_field_anim_timer += delta_ms;
-        gs->force_field_y_offset = sinf(gs->force_field_anim_timer / 200.0f) * 3.0f;
-
-        // Spawn particles
-        for (int j = 0; j < MAX_PARTICLES; j++) {
-            if (gs->particles[j].lifetime_ms <= 0) {
-                gs->particles[j].lifetime_ms = 1000;
-                float left_x = gs->paddle.x - 13 + 12;
-                float right_x = gs->paddle.x + gs->paddle.w - 10 + 12;
-                gs->particles[j].pos.x = left_x + (rand() / (float)RAND_MAX) * (right_x - left_x);
-                gs->particles[j].pos.y = gs->paddle.y - 5 + gs->force_field_y_offset;
-                gs->particles[j].vel.x = 0;
-                gs->particles[j].vel.y = -0.025f - (rand() / (float)RAND_MAX) * 0.025f;
-                gs->particles[j].color.r = 100 + rand() % 50;
-                gs->particles[j].color.g = 150 + rand() % 50;
-                gs->particles[j].color.b = 255;
-                gs->particles[j].color.a = 255;
-                break;
-            }
-        }
-    }
-
-    // Update particles
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        if (gs->particles[i].lifetime_ms > 0) {
-            gs->particles[i].pos.x += gs->particles[i].vel.x * delta_ms;
-            gs->particles[i].pos.y += gs->particles[i].vel.y * delta_ms;
-            gs->particles[i].lifetime_ms -= delta_ms;
-            if (gs->particles[i].lifetime_ms < 0) {
-                gs->particles[i].lifetime_ms = 0;
-            }
-            gs->particles[i].color.a = (gs->particles[i].lifetime_ms / 1000.0f) * 255;
-        }
-    }
-}
-
-void render_gameplay(GameState* gs) {
-    float scale = 2.0f;
-    SDL_SetRenderDrawColor(gs->renderer, 0, 0, 0, 255);
-    SDL_RenderClear(gs->renderer);
-
-    if (!gs->ball_launched && !gs->paused) {
-        SDL_Color white = {255, 255, 255, 255};
-        SDL_Color gray = {192, 192, 192, 255};
-
-        const char* text1 = "USE ";
-        const char* text2 = "ARROWS";
-        const char* text3 = " TO MOVE AND ";
-        const char* text4 = "SPACE";
-        const char* text5 = " TO SHOOT";
-
-        SDL_Surface* s1 = TTF_RenderText_Blended(gs->font, text1, 0, gray);
-        SDL_Surface* s2 = TTF_RenderText_Blended(gs->font, text2, 0, white);
-        SDL_Surface* s3 = TTF_RenderText_Blended(gs->font, text3, 0, gray);
-        SDL_Surface* s4 = TTF_RenderText_Blended(gs->font, text4, 0, white);
-        SDL_Surface* s5 = TTF_RenderText_Blended(gs->font, text5, 0, gray);
-
-        float total_width = s1->w + s2->w + s3->w + s4->w + s5->w;
-        float current_x = (SCREEN_WIDTH - total_width) / 2.0f;
-        float y = TOP_MARGIN + (SCREEN_HEIGHT - TOP_MARGIN - s1->h) / 2.0f + 80.0f;
-
-        SDL_Texture* t1 = SDL_CreateTextureFromSurface(gs->renderer, s1);
-        SDL_FRect r1 = { current_x, y, s1->w, s1->h };
-        SDL_RenderTexture(gs->renderer, t1, NULL, &r1);
-        current_x += s1->w;
-
-        SDL_Texture* t2 = SDL_CreateTextureFromSurface(gs->renderer, s2);
-        SDL_FRect r2 = { current_x, y, s2->w, s2->h };
-        SDL_RenderTexture(gs->renderer, t2, NULL, &r2);
-        current_x += s2->w;
-
-        SDL_Texture* t3 = SDL_CreateTextureFromSurface(gs->renderer, s3);
-        SDL_FRect r3 = { current_x, y, s3->w, s3->h };
-        SDL_RenderTexture(gs->renderer, t3, NULL, &r3);
-        current_x += s3->w;
-
-        SDL_Texture* t4 = SDL_CreateTextureFromSurface(gs->renderer, s4);
-        SDL_FRect r4 = { current_x, y, s4->w, s4->h };
-        SDL_RenderTexture(gs->renderer, t4, NULL, &r4);
-        current_x += s4->w;
-
-        SDL_Texture* t5 = SDL_CreateTextureFromSurface(gs->renderer, s5);
-        SDL_FRect r5 = { current_x, y, s5->w, s5->h };
-        SDL_RenderTexture(gs->renderer, t5, NULL, &r5);
-
-        SDL_DestroyTexture(t1);
-        SDL_DestroyTexture(t2);
-        SDL_DestroyTexture(t3);
-        SDL_DestroyTexture(t4);
-        SDL_DestroyTexture(t5);
-        SDL_DestroySurface(s1);
-        SDL_DestroySurface(s2);
-        SDL_DestroySurface(s3);
-        SDL_DestroySurface(s4);
-        SDL_DestroySurface(s5);
-    }
-
-    // Draw borders
-    SDL_SetRenderDrawColor(gs->renderer, 192, 192, 192, 255);
-    SDL_FRect top_border = {0, TOP_MARGIN - BORDER_THICKNESS, SCREEN_WIDTH, BORDER_THICKNESS};
-    SDL_RenderFillRect(gs->renderer, &top_border);
-    SDL_FRect left_border = {0, 0, BORDER_THICKNESS, SCREEN_HEIGHT};
-    SDL_RenderFillRect(gs->renderer, &left_border);
-    SDL_FRect right_border = {SCREEN_WIDTH - BORDER_THICKNESS, 0, BORDER_THICKNESS, SCREEN_HEIGHT};
-    SDL_RenderFillRect(gs->renderer, &right_border);
-
-    // Draw paddle
-    if (gs->debug_mode && gs->debug_render_collisions) {
-        SDL_SetRenderDrawColor(gs->renderer, 255, 0, 0, 255);
-        SDL_RenderFillRect(gs->renderer, &gs->paddle);
-    } else {
-        bool is_sticky_paddle_active = gs->sticky_paddle_timer_ms > 0;
-
-        SDL_FRect left_paddle_src = { 112, 48, 6, 14 };
-        SDL_FRect right_paddle_src = { 138, 48, 6, 14 };
-        SDL_FRect middle_paddle_src = { 118, 50, 20, 10 };
-
-        float left_w = left_paddle_src.w * scale;
-        float right_w = right_paddle_src.w * scale;
-        float middle_h = middle_paddle_src.h * scale;
-
-        SDL_FRect left_paddle_dest = { gs->paddle.x, gs->paddle.y - 4, left_w, 28 };
-        SDL_FRect right_paddle_dest = { gs->paddle.x + gs->paddle.w - right_w, gs->paddle.y - 4, right_w, 28 };
-        SDL_FRect middle_paddle_dest = { gs->paddle.x + left_w, gs->paddle.y + (PADDLE_HEIGHT - middle_h) / 2.0f, gs->paddle.w - left_w - right_w, middle_h };
-
-        SDL_RenderTexture(gs->renderer, gs->spritesheet, &left_paddle_src, &left_paddle_dest);
-        SDL_RenderTexture(gs->renderer, gs->spritesheet, &right_paddle_src, &right_paddle_dest);
-        SDL_RenderTexture(gs->renderer, gs->spritesheet, &middle_paddle_src, &middle_paddle_dest);
-
-        if (is_sticky_paddle_active) {
-            SDL_FRect sticky_src = { 132, 16, 12, 16 };
-            SDL_FRect sticky_dest_left = { gs->paddle.x - 13, gs->paddle.y - 5, 12 * scale, 16 * scale };
-            SDL_RenderTexture(gs->renderer, gs->spritesheet, &sticky_src, &sticky_dest_left);
-
-            SDL_FRect sticky_dest_right = { gs->paddle.x + gs->paddle.w - 10, gs->paddle.y - 5, 12 * scale, 16 * scale };
-            SDL_RenderTextureRotated(gs->renderer, gs->spritesheet, &sticky_src, &sticky_dest_right, 0, NULL, SDL_FLIP_HORIZONTAL);
-
-            // Draw force field
-            float left_x = sticky_dest_left.x + sticky_dest_left.w / 2;
-            float right_x = sticky_dest_right.x + sticky_dest_right.w / 2;
-            float y = sticky_dest_left.y + 2 + gs->force_field_y_offset;
-            
-            Uint8 r = 100 + sinf(gs->force_field_anim_timer / 150.0f) * 50;
-            Uint8 g = 150 + sinf(gs->force_field_anim_timer / 180.0f) * 50;
-            SDL_SetRenderDrawColor(gs->renderer, r, g, 255, 150);
-            SDL_RenderLine(gs->renderer, left_x, y, right_x, y);
-            SDL_RenderLine(gs->renderer, left_x, y+1, right_x, y+1);
-        }
-    }
-
-    // Draw particles
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        if (gs->particles[i].lifetime_ms > 0) {
-            SDL_SetRenderDrawColor(gs->renderer, gs->particles[i].color.r, gs->particles[i].color.g, gs->particles[i].color.b, gs->particles[i].color.a);
-            SDL_FRect particle_rect = { gs->particles[i].pos.x, gs->particles[i].pos.y, scale, scale };
-            SDL_RenderFillRect(gs->renderer, &particle_rect);
-        }
-    }
-
-    SDL_FRect ball_src_rect = { 50, 34, 12, 12 };
-    for (int i = 0; i < MAX_BALLS; i++) {
-        if (gs->balls[i].active) {
-            if (gs->debug_mode && gs->debug_render_collisions) {
-                SDL_SetRenderDrawColor(gs->renderer, 0, 255, 0, 255);
-                SDL_RenderFillRect(gs->renderer, &gs->balls[i].rect);
-            } else {
-                SDL_RenderTexture(gs->renderer, gs->spritesheet, &ball_src_rect, &gs->balls[i].rect);
-            }
+            printf("Usage: %s [--record FILE | --replay FILE] [--frame-log FILE] [--vsync | --limit | --fps N | --uncapped] [--levels FILE] [--chaos] [--bot]\n"
+                "       [--versus 0|1 --port N --peer-port N [--peer HOST] [--latency-ms N] [--jitter-ms N] [--loss PERCENT]]\n", argv[0]);
+            return 1;
         }
     }
-
-    for (int i = 0; i < BRICK_ROWS; i++) {
-        for (int j = 0; j < BRICK_COLS; j++) {
-            if (gs->bricks[i][j].active) {
-                if (gs->debug_mode && gs->debug_render_collisions) {
-                    SDL_SetRenderDrawColor(gs->renderer, 0, 0, 255, 255);
-                    SDL_RenderFillRect(gs->renderer, &gs->bricks[i][j].rect);
-                } else {
-                    int frame = gs->bricks[i][j].animation_frame;
-                    int src_x = 32 + (frame * 32);
-                    int src_y = 176 + i * 16;
-                    SDL_FRect src_rect = { src_x, src_y, 32, 16 };
-                    SDL_RenderTexture(gs->renderer, gs->spritesheet, &src_rect, &gs->bricks[i][j].rect);
-                }
-            }
+    if (app.versus_player >= 0) {
+        if (app.replay != NULL || app.record_path != NULL || app.chaos || port <= 0 || peer_port <= 0) {
+            printf("Versus needs --port and --peer-port, and can't be recorded, replayed or played in chaos mode\n");
+            return 1;
         }
-    }
-
-    int balls_per_col = (TOP_MARGIN - 2 * BORDER_THICKNESS) / (BALL_SIZE + 3);
-    for (int i = 0; i < gs->lives; i++) {
-        int col = i / balls_per_col;
-        int row = i % balls_per_col;
-        SDL_FRect life_ball = {
-            SCREEN_WIDTH - BORDER_THICKNESS - 5 - (col + 1) * (BALL_SIZE + 3) + 3,
-            BORDER_THICKNESS + 5 + row * (BALL_SIZE + 3),
-            BALL_SIZE,
-            BALL_SIZE
-        };
-        SDL_RenderTexture(gs->renderer, gs->spritesheet, &ball_src_rect, &life_ball);
-    }
-
-    // Draw powerups
-    for (int i = 0; i < MAX_POWERUPS; i++) {
-        if (gs->powerups[i].active) {
-            SDL_SetRenderDrawColor(gs->renderer, 255, 255, 255, 255);
-            draw_rounded_rect(gs->renderer, &gs->powerups[i].rect, 3);
-
-            SDL_SetRenderDrawColor(gs->renderer, 0, 0, 0, 255);
-            float line_thickness = POWERUP_SIZE / 5.0f;
-            if (gs->powerups[i].type == POWERUP_ADD_LIFE) {
-                SDL_FRect h_line = {gs->powerups[i].rect.x, gs->powerups[i].rect.y + (POWERUP_SIZE / 2.0f) - (line_thickness / 2.0f), POWERUP_SIZE, line_thickness};
-                SDL_FRect v_line = {gs->powerups[i].rect.x + (POWERUP_SIZE / 2.0f) - (line_thickness / 2.0f), gs->powerups[i].rect.y, line_thickness, POWERUP_SIZE};
-                SDL_RenderFillRect(gs->renderer, &h_line);
-                SDL_RenderFillRect(gs->renderer, &v_line);
-            } else if (gs->powerups[i].type == POWERUP_REMOVE_LIFE) {
-                SDL_FRect h_line = {gs->powerups[i].rect.x, gs->powerups[i].rect.y + (POWERUP_SIZE / 2.0f) - (line_thickness / 2.0f), POWERUP_SIZE, line_thickness};
-                SDL_RenderFillRect(gs->renderer, &h_line);
-            } else if (gs->powerups[i].type == POWERUP_PADDLE_WIDER) {
-                SDL_RenderLine(gs->renderer, gs->powerups[i].rect.x, gs->powerups[i].rect.y, gs->powerups[i].rect.x + gs->powerups[i].rect.w, gs->powerups[i].rect.y + gs->powerups[i].rect.h / 2);
-                SDL_RenderLine(gs->renderer, gs->powerups[i].rect.x + gs->powerups[i].rect.w, gs->powerups[i].rect.y + gs->powerups[i].rect.h / 2, gs->powerups[i].rect.x, gs->powerups[i].rect.y + gs->powerups[i].rect.h);
-            } else if (gs->powerups[i].type == POWERUP_PADDLE_NARROWER) {
-                SDL_RenderLine(gs->renderer, gs->powerups[i].rect.x + gs->powerups[i].rect.w, gs->powerups[i].rect.y, gs->powerups[i].rect.x, gs->powerups[i].rect.y + gs->powerups[i].rect.h / 2);
-                SDL_RenderLine(gs->renderer, gs->powerups[i].rect.x, gs->powerups[i].rect.y + gs->powerups[i].rect.h / 2, gs->powerups[i].rect.x + gs->powerups[i].rect.w, gs->powerups[i].rect.y + gs->powerups[i].rect.h);
-            } else if (gs->powerups[i].type == POWERUP_BALL_SPLIT) {
-                float cx = gs->powerups[i].rect.x + POWERUP_SIZE / 2;
-                float cy = gs->powerups[i].rect.y + POWERUP_SIZE / 2;
-                float r = POWERUP_SIZE / 2;
-                SDL_RenderLine(gs->renderer, cx, cy - r, cx, cy + r);
-                SDL_RenderLine(gs->renderer, cx - r, cy, cx + r, cy);
-                SDL_RenderLine(gs->renderer, cx - r, cy - r, cx + r, cy + r);
-                SDL_RenderLine(gs->renderer, cx - r, cy + r, cx + r, cy - r);
-            } else if (gs->powerups[i].type == POWERUP_STICKY_PADDLE) {
-                float x = gs->powerups[i].rect.x;
-                float y = gs->powerups[i].rect.y;
-                float w = gs->powerups[i].rect.w;
-                float h = gs->powerups[i].rect.h;
-                SDL_RenderLine(gs->renderer, x + w/4, y, x + w/4, y + h);
-                SDL_RenderLine(gs->renderer, x + 3*w/4, y, x + 3*w/4, y + h);
-                SDL_RenderLine(gs->renderer, x, y + h/4, x + w, y + h/4);
-                SDL_RenderLine(gs->renderer, x, y + 3*h/4, x + w, y + 3*h/4);
-            }
+        app.net_socket = net_socket_open((Uint16)port, peer_host, (Uint16)peer_port, conditions, (Uint64)port);
+        if (app.net_socket == NULL) {
+            return 1;
         }
     }
-
-    if (gs->paused) {
-        SDL_Color text_color = {255, 255, 255, 255};
-        SDL_Surface* text_surface = TTF_RenderText_Blended(gs->font, "PAUSED", 0, text_color);
-        SDL_Texture* text_texture = SDL_CreateTextureFromSurface(gs->renderer, text_surface);
-        SDL_FRect text_rect = {
-            (SCREEN_WIDTH - text_surface->w) / 2.0f,
-            (SCREEN_HEIGHT - text_surface->h) / 2.0f,
-            text_surface->w,
-            text_surface->h
-        };
-        SDL_RenderTexture(gs->renderer, text_texture, NULL, &text_rect);
-        SDL_DestroyTexture(text_texture);
-        SDL_DestroySurface(text_surface);
-    }
-
-    if (gs->show_speed_timer > 0) {
-        SDL_Color text_color = {255, 255, 255, 255};
-        char speed_text[20];
-        snprintf(speed_text, 20, "SPEED %.0f%%", gs->game_speed * 100);
-        SDL_Surface* text_surface = TTF_RenderText_Blended(gs->font, speed_text, 0, text_color);
-        SDL_Texture* text_texture = SDL_CreateTextureFromSurface(gs->renderer, text_surface);
-        SDL_FRect text_rect = {
-            (SCREEN_WIDTH - text_surface->w) / 2.0f,
-            (SCREEN_HEIGHT - text_surface->h) / 2.0f + 30,
-            text_surface->w,
-            text_surface->h
-        };
-        SDL_RenderTexture(gs->renderer, text_texture, NULL, &text_rect);
-        SDL_DestroyTexture(text_texture);
-        SDL_DestroySurface(text_surface);
-    }
-
-    if (gs->debug_mode) {
-        SDL_Color text_color = {255, 255, 255, 255};
-        SDL_Surface* text_surface = TTF_RenderText_Blended(gs->font, "DEBUG", 0, text_color);
-        SDL_Texture* text_texture = SDL_CreateTextureFromSurface(gs->renderer, text_surface);
-        SDL_FRect text_rect = {
-            5,
-            SCREEN_HEIGHT - text_surface->h - 5,
-            text_surface->w,
-            text_surface->h
-        };
-        SDL_RenderTexture(gs->renderer, text_texture, NULL, &text_rect);
-        SDL_DestroyTexture(text_texture);
-        SDL_DestroySurface(text_surface);
+    // Looked for next to the executable, so the working directory doesn't matter
+    char default_pack[1024];
+    const char* base_path = SDL_GetBasePath();
+    snprintf(default_pack, sizeof(default_pack), "%s%s", base_path != NULL ? base_path : "", DEFAULT_LEVEL_PACK);
+    if (levels_path == NULL && file_exists(default_pack)) {
+        levels_path = default_pack;
     }
-
-    SDL_RenderPresent(gs->renderer);
-}
-
-void render_title_screen(GameState* gs) {
-    SDL_SetRenderDrawColor(gs->renderer, 0, 0, 0, 255);
-    SDL_RenderClear(gs->renderer);
-
-    SDL_Color text_color = {255, 255, 255, 255};
-    SDL_Surface* title_surface = TTF_RenderText_Solid(gs->font, "Bricked Up", 0, text_color);
-    SDL_Texture* title_texture = SDL_CreateTextureFromSurface(gs->renderer, title_surface);
-    SDL_FRect title_rect = {
-        (SCREEN_WIDTH - title_surface->w) / 2.0f,
-        (SCREEN_HEIGHT / 2.0f) - title_surface->h,
-        title_surface->w,
-        title_surface->h
-    };
-    SDL_RenderTexture(gs->renderer, title_texture, NULL, &title_rect);
-    SDL_DestroyTexture(title_texture);
-    SDL_DestroySurface(title_surface);
-
-    SDL_Surface* instruction_surface = TTF_RenderText_Solid(gs->font, "Press Enter to Start", 0, text_color);
-    SDL_Texture* instruction_texture = SDL_CreateTextureFromSurface(gs->renderer, instruction_surface);
-    SDL_FRect instruction_rect = {
-        (SCREEN_WIDTH - instruction_surface->w) / 2.0f,
-        (SCREEN_HEIGHT / 2.0f) + instruction_surface->h,
-        instruction_surface->w,
-        instruction_surface->h
-    };
-    SDL_RenderTexture(gs->renderer, instruction_texture, NULL, &instruction_rect);
-    SDL_DestroyTexture(instruction_texture);
-    SDL_DestroySurface(instruction_surface);
-
-    SDL_RenderPresent(gs->renderer);
-}
-
-void render_game_over_screen(GameState* gs) {
-    SDL_SetRenderDrawColor(gs->renderer, 0, 0, 0, 255);
-    SDL_RenderClear(gs->renderer);
-
-    SDL_Color text_color = {255, 255, 255, 255};
-    SDL_Surface* title_surface = TTF_RenderText_Solid(gs->font, "Game Over", 0, text_color);
-    SDL_Texture* title_texture = SDL_CreateTextureFromSurface(gs->renderer, title_surface);
-    SDL_FRect title_rect = {
-        (SCREEN_WIDTH - title_surface->w) / 2.0f,
-        (SCREEN_HEIGHT / 2.0f) - title_surface->h,
-        title_surface->w,
-        title_surface->h
-    };
-    SDL_RenderTexture(gs->renderer, title_texture, NULL, &title_rect);
-    SDL_DestroyTexture(title_texture);
-    SDL_DestroySurface(title_surface);
-
-    SDL_Surface* instruction_surface = TTF_RenderText_Solid(gs->font, "Press Enter to Return to Title", 0, text_color);
-    SDL_Texture* instruction_texture = SDL_CreateTextureFromSurface(gs->renderer, instruction_surface);
-    SDL_FRect instruction_rect = {
-        (SCREEN_WIDTH - instruction_surface->w) / 2.0f,
-        (SCREEN_HEIGHT / 2.0f) + instruction_surface->h,
-        instruction_surface->w,
-        instruction_surface->h
-    };
-    SDL_RenderTexture(gs->renderer, instruction_texture, NULL, &instruction_rect);
-    SDL_DestroyTexture(instruction_texture);
-    SDL_DestroySurface(instruction_surface);
-
-    SDL_RenderPresent(gs->renderer);
-}
-
-int main(int argc, char* argv[]) {
-    SDL_Init(SDL_INIT_VIDEO);
-    TTF_Init();
-
-    GameState gs;
-    gs.window = SDL_CreateWindow("Bricked Up", SCREEN_WIDTH, SCREEN_HEIGHT, 0);
-    gs.renderer = SDL_CreateRenderer(gs.window, NULL);
-    gs.font = TTF_OpenFont("assets/NotoSansMono-Regular.ttf", 20);
-    if (gs.font == NULL) {
-        printf("Failed to load font: %s\n", SDL_GetError());
+    if (!asset_loader_start(&app.loader, levels_path)) {
         return 1;
     }
-
-    gs.spritesheet = IMG_LoadTexture(gs.renderer, "assets/spritesheet-breakout.png");
-    if (gs.spritesheet == NULL) {
-        printf("Failed to load spritesheet: %s\n", SDL_GetError());
+    if (!frame_pacer_init(&app.pacer, app.window, app.renderer, pacing, target_hz)) {
         return 1;
     }
-    SDL_SetTextureScaleMode(gs.spritesheet, SDL_SCALEMODE_NEAREST);
-
-    reset_game(&gs);
-    srand(time(NULL));
+    app.start_requested = app.playing_replay || app.versus_player >= 0 || app.bot_playing;
 
-    gs.quit = false;
-    gs.last_frame_time = SDL_GetTicks();
-    gs.current_screen = SCREEN_TITLE;
+    while (!app.quit) {
+        float alpha;
+        const SimSnapshot* snapshot;
+        Uint64 now_ns;
 
-    while (!gs.quit) {
-        Uint64 current_time = SDL_GetTicks();
-        Uint64 delta_ms = current_time - gs.last_frame_time;
-        gs.last_frame_time = current_time;
-
-        switch (gs.current_screen) {
+        frame_stats_begin_frame(&app.frame_stats);
+        if (!app.assets_ready && asset_loader_done(&app.loader) && !finish_loading(&app)) {
+            return 1;
+        }
+        switch (app.current_screen) {
             case SCREEN_TITLE:
-                handle_events_title(&gs);
-                render_title_screen(&gs);
+                handle_events_title(&app);
+                frame_stats_mark(&app.frame_stats, FRAME_PHASE_EVENTS);
+                render_title_screen(&app);
+                frame_stats_mark(&app.frame_stats, FRAME_PHASE_RENDER);
                 break;
             case SCREEN_GAMEPLAY:
-                handle_events_gameplay(&gs);
-                update_gameplay(&gs, delta_ms);
-                render_gameplay(&gs);
+                handle_events_gameplay(&app);
+                frame_stats_mark(&app.frame_stats, FRAME_PHASE_EVENTS);
+                if (app.netplay != NULL) {
+                    bot_input(&app);
+                    update_versus(&app);
+                    frame_stats_mark(&app.frame_stats, FRAME_PHASE_UPDATE);
+                    // Rollbacks can move a board anywhere, so frames show the latest step as is
+                    render_gameplay(&app, 1.0f);
+                    render_paddle(&app, 1.0f, app.view->paddle.x);
+                    frame_stats_mark(&app.frame_stats, FRAME_PHASE_RENDER);
+                    break;
+                }
+                // The simulation steps on its own thread; this frame draws the newest snapshot
+                snapshot = sim_thread_latest(app.sim);
+                app.view = &snapshot->gs;
+                bot_input(&app);
+                now_ns = SDL_GetTicksNS();
+                alpha = sim_thread_alpha(snapshot, now_ns);
+                app.frame_stats.current.steps = snapshot->clock.steps - app.shown_steps;
+                app.shown_steps = snapshot->clock.steps;
+                if (app.show_speed_timer_ns > now_ns - app.last_frame_ns) {
+                    app.show_speed_timer_ns -= now_ns - app.last_frame_ns;
+                } else {
+                    app.show_speed_timer_ns = 0;
+                }
+                app.last_frame_ns = now_ns;
+                if (snapshot->ended) {
+                    sim_thread_stop(app.sim);
+                    app.view = &app.gs;
+                    bool replay_ended = app.playing_replay;
+                    finish_replay(&app);
+                    if (app.gs.game_over) {
+                        if (app.bot_playing) {
+                            printf("Bot game over after %.1f s, %d boards cleared\n", app.gs.sim_time_ns / 1e9, app.gs.stats.boards_cleared);
+                        }
+                        app.current_screen = SCREEN_GAMEOVER;
+                    } else if (replay_ended) {
+                        app.quit = true;
+                    }
+                }
+                frame_stats_mark(&app.frame_stats, FRAME_PHASE_UPDATE);
+                render_gameplay(&app, alpha);
+                frame_stats_mark(&app.frame_stats, FRAME_PHASE_RENDER);
+
+                // Late latch: take in keys pressed while the frame was drawn and put the
+                // paddle where it will be on screen, right before presenting
+                handle_events_gameplay(&app);
+                frame_stats_mark(&app.frame_stats, FRAME_PHASE_EVENTS);
+                now_ns = SDL_GetTicksNS();
+                render_paddle(&app, alpha, app.view == &app.gs ? sim_predict_paddle_x(&app.gs, &app.clock, alpha, now_ns) :
+                    sim_thread_predict_paddle_x(app.sim, snapshot, alpha, now_ns));
+                frame_stats_mark(&app.frame_stats, FRAME_PHASE_RENDER);
                 break;
             case SCREEN_GAMEOVER:
-                handle_events_gameover(&gs);
-                render_game_over_screen(&gs);
+                handle_events_gameover(&app);
+                if (app.bot_playing && app.netplay == NULL && !app.quit) {
+                    start_game(&app, fresh_seed());
+                }
+                frame_stats_mark(&app.frame_stats, FRAME_PHASE_EVENTS);
+                render_game_over_screen(&app);
+                frame_stats_mark(&app.frame_stats, FRAME_PHASE_RENDER);
                 break;
         }
 
-        SDL_Delay(16);
-    }
+        SDL_RenderPresent(app.renderer);
+        frame_stats_mark(&app.frame_stats, FRAME_PHASE_PRESENT);
+        if (app.unshown_input_ns != 0) {
+            app.frame_stats.current.input_latency_ns = SDL_GetTicksNS() - app.unshown_input_ns;
+            app.unshown_input_ns = 0;
+        }
 
-    SDL_DestroyTexture(gs.spritesheet);
-    TTF_CloseFont(gs.font);
-    SDL_DestroyRenderer(gs.renderer);
-    SDL_DestroyWindow(gs.window);
+        app.frame_stats.current.missed = frame_pacer_wait(&app.pacer);
+    }
+
+    if (!app.assets_ready) {
+        take_loaded_assets(&app);
+    }
+    sim_thread_destroy(app.sim);
+    rewind_destroy(app.rewind);
+    netplay_destroy(app.netplay);
+    net_socket_close(app.net_socket);
+    finish_replay(&app);
+    frame_stats_close(&app.frame_stats);
+    if (app.pacer.missed > 0) {
+        printf("Missed %llu of %llu frame deadlines (%s, %.0f Hz)\n", (unsigned long long)app.pacer.missed,
+            (unsigned long long)app.pacer.frames, pacing_mode_names[app.pacer.mode], app.pacer.target_hz);
+    }
+    render_shutdown(&app);
+    level_pack_close(app.level_pack);
+    job_pool_destroy(app.jobs);
+    if (app.spritesheet != NULL) SDL_DestroyTexture(app.spritesheet);
+    if (app.font != NULL) TTF_CloseFont(app.font);
+    SDL_DestroyRenderer(app.renderer);
+    SDL_DestroyWindow(app.window);
     TTF_Quit();
     SDL_Quit();
 
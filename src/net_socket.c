@@ -0,0 +1,163 @@
+#include "net_socket.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET SocketHandle;
+#define INVALID_SOCKET_HANDLE INVALID_SOCKET
+#define close_socket closesocket
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SocketHandle;
+#define INVALID_SOCKET_HANDLE (-1)
+#define close_socket close
+#endif
+
+typedef struct {
+    Uint64 due_ns;
+    int size;
+    Uint8 data[NET_MAX_PACKET];
+} DelayedPacket;
+
+struct NetSocket {
+    SocketHandle handle;
+    struct sockaddr_in peer;
+    NetConditions conditions;
+    Uint64 rng_state;
+    DelayedPacket delayed[NET_DELAY_QUEUE]; // unordered; jitter lets later packets overtake
+    int delayed_count;
+    NetSocketStats stats;
+};
+
+// xorshift64*, like the game's own generator, so a seed gives the same losses every run
+static float net_randf(NetSocket* sock) {
+    sock->rng_state ^= sock->rng_state >> 12;
+    sock->rng_state ^= sock->rng_state << 25;
+    sock->rng_state ^= sock->rng_state >> 27;
+    return (Uint32)((sock->rng_state * 0x2545F4914F6CDD1Dull) >> 40) / (float)(1 << 24);
+}
+
+static bool set_non_blocking(SocketHandle handle) {
+#ifdef _WIN32
+    u_long enabled = 1;
+    return ioctlsocket(handle, FIONBIO, &enabled) == 0;
+#else
+    int flags = fcntl(handle, F_GETFL, 0);
+    return flags != -1 && fcntl(handle, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+NetSocket* net_socket_open(Uint16 port, const char* peer_host, Uint16 peer_port, NetConditions conditions, Uint64 seed) {
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        printf("Failed to start Winsock\n");
+        return NULL;
+    }
+#endif
+    NetSocket* sock = calloc(1, sizeof(NetSocket));
+    if (sock == NULL) return NULL;
+    sock->conditions = conditions;
+    sock->rng_state = seed != 0 ? seed : 0x9E3779B97F4A7C15ull;
+
+    sock->peer.sin_family = AF_INET;
+    sock->peer.sin_port = htons(peer_port);
+    if (inet_pton(AF_INET, peer_host, &sock->peer.sin_addr) != 1) {
+        printf("Failed to parse peer address %s\n", peer_host);
+        free(sock);
+        return NULL;
+    }
+
+    sock->handle = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock->handle == INVALID_SOCKET_HANDLE) {
+        printf("Failed to create UDP socket\n");
+        free(sock);
+        return NULL;
+    }
+    struct sockaddr_in local = { 0 };
+    local.sin_family = AF_INET;
+    local.sin_port = htons(port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock->handle, (struct sockaddr*)&local, sizeof(local)) != 0 || !set_non_blocking(sock->handle)) {
+        printf("Failed to bind UDP port %u\n", port);
+        close_socket(sock->handle);
+        free(sock);
+        return NULL;
+    }
+    return sock;
+}
+
+void net_socket_close(NetSocket* sock) {
+    if (sock == NULL) return;
+    close_socket(sock->handle);
+    free(sock);
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+static void send_now(NetSocket* sock, const void* data, int size) {
+    // Errors are dropped packets as far as the other end can tell
+    sendto(sock->handle, data, size, 0, (struct sockaddr*)&sock->peer, sizeof(sock->peer));
+    sock->stats.sent++;
+}
+
+void net_socket_send(NetSocket* sock, const void* data, int size) {
+    if (size > NET_MAX_PACKET) return;
+    if (net_randf(sock) < sock->conditions.loss) {
+        sock->stats.dropped++;
+        return;
+    }
+    float delay_ms = sock->conditions.latency_ms + sock->conditions.jitter_ms * net_randf(sock);
+    if (delay_ms <= 0.0f) {
+        send_now(sock, data, size);
+        return;
+    }
+    if (sock->delayed_count == NET_DELAY_QUEUE) {
+        sock->stats.dropped++;
+        return;
+    }
+    DelayedPacket* packet = &sock->delayed[sock->delayed_count++];
+    packet->due_ns = SDL_GetTicksNS() + (Uint64)(delay_ms * SDL_NS_PER_MS);
+    packet->size = size;
+    memcpy(packet->data, data, size);
+    net_socket_flush(sock);
+}
+
+void net_socket_flush(NetSocket* sock) {
+    Uint64 now_ns = SDL_GetTicksNS();
+    for (int i = 0; i < sock->delayed_count;) {
+        DelayedPacket* packet = &sock->delayed[i];
+        if (packet->due_ns > now_ns) {
+            i++;
+            continue;
+        }
+        send_now(sock, packet->data, packet->size);
+        *packet = sock->delayed[--sock->delayed_count];
+    }
+}
+
+int net_socket_receive(NetSocket* sock, void* data, int capacity) {
+    net_socket_flush(sock);
+    struct sockaddr_in from;
+    socklen_t from_size = sizeof(from);
+    for (;;) {
+        int size = (int)recvfrom(sock->handle, data, capacity, 0, (struct sockaddr*)&from, &from_size);
+        // Nothing waiting, or an error such as the peer's port not being open yet
+        if (size <= 0) return 0;
+        if (from.sin_addr.s_addr != sock->peer.sin_addr.s_addr || from.sin_port != sock->peer.sin_port) continue;
+        sock->stats.received++;
+        return size;
+    }
+}
+
+NetSocketStats net_socket_stats(const NetSocket* sock) {
+    return sock->stats;
+}
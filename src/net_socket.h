@@ -0,0 +1,40 @@
+#ifndef BRICKED_UP_NET_SOCKET_H
+#define BRICKED_UP_NET_SOCKET_H
+
+// A non-blocking UDP socket talking to one peer, with simulated network conditions so
+// netplay can be tried out over loopback: outgoing packets are held back by a latency plus
+// random jitter (which can reorder them) and dropped at random.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#define NET_MAX_PACKET 512
+#define NET_DELAY_QUEUE 256 // packets held back at once; more are dropped
+
+typedef struct {
+    float latency_ms; // one way
+    float jitter_ms; // up to this much more, at random
+    float loss; // 0 to 1
+} NetConditions;
+
+typedef struct {
+    Uint64 sent;
+    Uint64 dropped; // by the simulated loss, or with the delay queue full
+    Uint64 received;
+} NetSocketStats;
+
+typedef struct NetSocket NetSocket;
+
+// Binds `port` on every interface and sends to `peer_host`:`peer_port` (an IPv4 address).
+NetSocket* net_socket_open(Uint16 port, const char* peer_host, Uint16 peer_port, NetConditions conditions, Uint64 seed);
+void net_socket_close(NetSocket* sock);
+
+void net_socket_send(NetSocket* sock, const void* data, int size);
+// Sends the held-back packets that are due. Call often; net_socket_send and
+// net_socket_receive do it too.
+void net_socket_flush(NetSocket* sock);
+// One packet from the peer into `data`; its size, or 0 if none is waiting.
+int net_socket_receive(NetSocket* sock, void* data, int capacity);
+NetSocketStats net_socket_stats(const NetSocket* sock);
+
+#endif
@@ -0,0 +1,246 @@
+#include "netplay.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NETPLAY_MAGIC 0x504E5542u // "BUNP"
+#define NETPLAY_HEADER_SIZE 13
+// Both boards' snapshots from the oldest frame a rollback can reach; chains are one
+// longer than that, so dropping the oldest chain still leaves enough
+#define NETPLAY_SNAPSHOT_CHAIN (NETPLAY_MAX_PREDICTION + 1)
+
+struct NetplaySession {
+    NetSocket* sock;
+    int local;
+    const LevelPack* levels;
+    GameState* boards[2];
+    RewindBuffer* snapshots[2]; // the newest is of the start of frame - 1
+    Uint8 inputs[2][NETPLAY_INPUT_HISTORY]; // by frame; the peer's past remote_frames are predictions
+    int frame;
+    int remote_frames; // the peer's inputs received, in order
+    int remote_acked; // our inputs the peer has received, in order
+    int rollback_from; // first frame run with a prediction that turned out wrong, or INT_MAX
+    NetplayResult result; // as of result_frame, which may not be confirmed yet
+    int result_frame;
+    NetplayStats stats;
+};
+
+static Uint8* input_at(NetplaySession* session, int player, int frame) {
+    return &session->inputs[player][frame & (NETPLAY_INPUT_HISTORY - 1)];
+}
+
+static void write_u32(Uint8* out, Uint32 value) {
+    out[0] = (Uint8)value;
+    out[1] = (Uint8)(value >> 8);
+    out[2] = (Uint8)(value >> 16);
+    out[3] = (Uint8)(value >> 24);
+}
+
+static Uint32 read_u32(const Uint8* in) {
+    return in[0] | (Uint32)in[1] << 8 | (Uint32)in[2] << 16 | (Uint32)in[3] << 24;
+}
+
+NetplaySession* netplay_create(int local_player, NetSocket* sock, Uint64 seed, const LevelPack* levels) {
+    NetplaySession* session = calloc(1, sizeof(NetplaySession));
+    if (session == NULL) return NULL;
+    session->sock = sock;
+    session->local = local_player;
+    session->levels = levels;
+    session->rollback_from = INT_MAX;
+    for (int p = 0; p < 2; p++) {
+        session->boards[p] = malloc(sizeof(GameState));
+        session->snapshots[p] = rewind_create(NETPLAY_SNAPSHOT_BYTES, 2 * NETPLAY_SNAPSHOT_CHAIN, NETPLAY_SNAPSHOT_CHAIN);
+        if (session->boards[p] == NULL || session->snapshots[p] == NULL) {
+            printf("Failed to allocate netplay boards\n");
+            netplay_destroy(session);
+            return NULL;
+        }
+        // The same seed for both, so neither player gets the easier serve
+        sim_start_game(session->boards[p], seed, levels);
+    }
+    return session;
+}
+
+void netplay_destroy(NetplaySession* session) {
+    if (session == NULL) return;
+    for (int p = 0; p < 2; p++) {
+        rewind_destroy(session->snapshots[p]);
+        free(session->boards[p]);
+    }
+    free(session);
+}
+
+static void apply_input(GameState* gs, Uint8 input) {
+    bool left = (input & NETPLAY_INPUT_LEFT) != 0;
+    bool right = (input & NETPLAY_INPUT_RIGHT) != 0;
+    if (left != gs->left_pressed) sim_apply_input(gs, left ? SIM_INPUT_LEFT_DOWN : SIM_INPUT_LEFT_UP);
+    if (right != gs->right_pressed) sim_apply_input(gs, right ? SIM_INPUT_RIGHT_DOWN : SIM_INPUT_RIGHT_UP);
+    if (input & NETPLAY_INPUT_LAUNCH) sim_apply_input(gs, SIM_INPUT_LAUNCH);
+}
+
+// Snapshots both boards, then steps them through `frame` with the inputs on record for it
+static void run_frame(NetplaySession* session, int frame) {
+    int cleared[2];
+    for (int p = 0; p < 2; p++) {
+        GameState* gs = session->boards[p];
+        rewind_capture(session->snapshots[p], gs);
+        cleared[p] = gs->stats.boards_cleared;
+        apply_input(gs, *input_at(session, p, frame));
+        update_gameplay(gs, SIM_STEP_NS);
+    }
+    for (int p = 0; p < 2; p++) {
+        GameState* opponent = session->boards[1 - p];
+        if (session->boards[p]->stats.boards_cleared > cleared[p] && opponent->lives > 1) {
+            opponent->lives--;
+        }
+    }
+    if (session->result == NETPLAY_PLAYING && (session->boards[0]->game_over || session->boards[1]->game_over)) {
+        bool over[2] = { session->boards[0]->game_over, session->boards[1]->game_over };
+        session->result = over[0] && over[1] ? NETPLAY_DRAW : over[0] ? NETPLAY_WON_BY_1 : NETPLAY_WON_BY_0;
+        session->result_frame = frame;
+    }
+}
+
+static void send_inputs(NetplaySession* session) {
+    if (session->sock == NULL) return;
+    Uint8 packet[NETPLAY_HEADER_SIZE + NETPLAY_INPUT_WINDOW];
+    int first = SDL_max(session->remote_acked, session->frame - NETPLAY_INPUT_WINDOW);
+    int count = session->frame - first;
+    write_u32(packet, NETPLAY_MAGIC);
+    write_u32(packet + 4, (Uint32)session->remote_frames);
+    write_u32(packet + 8, (Uint32)first);
+    packet[12] = (Uint8)count;
+    for (int i = 0; i < count; i++) {
+        packet[NETPLAY_HEADER_SIZE + i] = *input_at(session, session->local, first + i);
+    }
+    net_socket_send(session->sock, packet, NETPLAY_HEADER_SIZE + count);
+}
+
+// Takes the peer's inputs that come next in order, and notes the first frame that ran on a
+// wrong guess. Later frames are guessed again from the newest real input.
+static void receive_inputs(NetplaySession* session, const Uint8* packet, int size) {
+    if (size < NETPLAY_HEADER_SIZE || read_u32(packet) != NETPLAY_MAGIC) return;
+    int acked = (int)read_u32(packet + 4);
+    int first = (int)read_u32(packet + 8);
+    int count = packet[12];
+    if (size < NETPLAY_HEADER_SIZE + count) return;
+    session->remote_acked = SDL_max(session->remote_acked, SDL_min(acked, session->frame));
+
+    int remote = 1 - session->local;
+    int had = session->remote_frames;
+    for (int frame = session->remote_frames; frame < first + count; frame++) {
+        if (frame < first) return; // a gap; a later packet resends it
+        if (frame >= session->frame + NETPLAY_MAX_PREDICTION + 1) break; // can't be, short of a broken peer
+        Uint8 input = packet[NETPLAY_HEADER_SIZE + frame - first];
+        if (frame < session->frame && *input_at(session, remote, frame) != input) {
+            session->rollback_from = SDL_min(session->rollback_from, frame);
+        }
+        *input_at(session, remote, frame) = input;
+        session->remote_frames = frame + 1;
+    }
+    if (session->remote_frames == had) return;
+
+    Uint8 guess = *input_at(session, remote, session->remote_frames - 1);
+    for (int frame = session->remote_frames; frame < session->frame; frame++) {
+        if (*input_at(session, remote, frame) != guess) {
+            session->rollback_from = SDL_min(session->rollback_from, frame);
+            *input_at(session, remote, frame) = guess;
+        }
+    }
+}
+
+void netplay_rollback(NetplaySession* session, int frame) {
+    int back = session->frame - frame;
+    if (back <= 0) return;
+    Uint64 start_ns = SDL_GetTicksNS();
+    if (session->result != NETPLAY_PLAYING && session->result_frame >= frame) {
+        session->result = NETPLAY_PLAYING;
+    }
+    for (int p = 0; p < 2; p++) {
+        RewindBuffer* snapshots = session->snapshots[p];
+        int index = rewind_count(snapshots) - back;
+        if (index < 0) {
+            printf("Netplay can't roll back %d frames\n", back);
+            return;
+        }
+        rewind_restore(snapshots, index, session->boards[p]);
+        // run_frame snapshots the frames again on the way forward
+        rewind_truncate(snapshots, index);
+    }
+    for (int f = frame; f < session->frame; f++) {
+        run_frame(session, f);
+    }
+    Uint64 elapsed_ns = SDL_GetTicksNS() - start_ns;
+    session->stats.rollbacks++;
+    session->stats.resimulated_frames += back;
+    session->stats.max_rollback_frames = SDL_max(session->stats.max_rollback_frames, back);
+    session->stats.rollback_ns_total += elapsed_ns;
+    session->stats.rollback_ns_max = SDL_max(session->stats.rollback_ns_max, elapsed_ns);
+}
+
+static void take_packets(NetplaySession* session) {
+    Uint8 packet[NET_MAX_PACKET];
+    int size;
+    while (session->sock != NULL && (size = net_socket_receive(session->sock, packet, sizeof(packet))) > 0) {
+        receive_inputs(session, packet, size);
+    }
+    if (session->rollback_from < session->frame) {
+        netplay_rollback(session, session->rollback_from);
+    }
+    session->rollback_from = INT_MAX;
+}
+
+void netplay_poll(NetplaySession* session) {
+    take_packets(session);
+    // Keeps resending, in case the peer is still missing our last inputs
+    send_inputs(session);
+}
+
+bool netplay_advance(NetplaySession* session, Uint8 local_input) {
+    take_packets(session);
+    if (session->frame - session->remote_frames >= NETPLAY_MAX_PREDICTION) {
+        session->stats.stalls++;
+        send_inputs(session);
+        return false;
+    }
+
+    int frame = session->frame;
+    int remote = 1 - session->local;
+    *input_at(session, session->local, frame) = local_input;
+    if (frame >= session->remote_frames) {
+        *input_at(session, remote, frame) = frame > 0 ? *input_at(session, remote, frame - 1) : 0;
+    }
+    run_frame(session, frame);
+    session->frame++;
+    session->stats.frames++;
+    send_inputs(session);
+    return true;
+}
+
+const GameState* netplay_board(const NetplaySession* session, int player) {
+    return session->boards[player];
+}
+
+int netplay_local_player(const NetplaySession* session) {
+    return session->local;
+}
+
+int netplay_frame(const NetplaySession* session) {
+    return session->frame;
+}
+
+int netplay_confirmed_frames(const NetplaySession* session) {
+    return SDL_min(session->frame, session->remote_frames);
+}
+
+NetplayStats netplay_stats(const NetplaySession* session) {
+    return session->stats;
+}
+
+NetplayResult netplay_result(const NetplaySession* session) {
+    if (session->result == NETPLAY_PLAYING || netplay_confirmed_frames(session) <= session->result_frame) {
+        return NETPLAY_PLAYING;
+    }
+    return session->result;
+}
@@ -0,0 +1,73 @@
+#ifndef BRICKED_UP_NETPLAY_H
+#define BRICKED_UP_NETPLAY_H
+
+// Two-player versus over UDP with rollback. Each peer runs both boards. Its own inputs go
+// in at once. The other player's are predicted to stay as they last were. When the real
+// ones arrive and differ, both boards go back to a snapshot from before the first wrong
+// frame and are stepped forward again with the corrected inputs, all within one call.
+//
+// Each player's board is a GameState of its own, and clearing a board costs the opponent
+// a life (never the last), so the boards depend on each other and roll back together.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include "sim.h"
+#include "rewind.h"
+#include "net_socket.h"
+
+#define NETPLAY_MAX_PREDICTION 8 // frames a peer runs ahead of the inputs it has; past that it waits
+#define NETPLAY_INPUT_HISTORY 128 // power of two, well past what a packet resends
+#define NETPLAY_INPUT_WINDOW 64 // unacknowledged inputs resent in each packet
+#define NETPLAY_SNAPSHOT_BYTES (32 * 1024 * 1024) // per board
+
+// One player's input for one frame
+#define NETPLAY_INPUT_LEFT 0x1
+#define NETPLAY_INPUT_RIGHT 0x2
+#define NETPLAY_INPUT_LAUNCH 0x4
+
+typedef struct {
+    Uint64 frames;
+    Uint64 stalls; // netplay_advance calls that waited on the peer
+    Uint64 rollbacks;
+    Uint64 resimulated_frames;
+    int max_rollback_frames;
+    Uint64 rollback_ns_total; // restoring plus stepping forward again
+    Uint64 rollback_ns_max;
+} NetplayStats;
+
+typedef enum {
+    NETPLAY_PLAYING,
+    NETPLAY_WON_BY_0,
+    NETPLAY_WON_BY_1,
+    NETPLAY_DRAW, // both boards ended on the same frame
+} NetplayResult;
+
+typedef struct NetplaySession NetplaySession;
+
+// `local_player` is 0 or 1; both peers must agree on `seed` and the level pack. A NULL
+// `sock` plays with no peer, whose inputs then stay predicted, for benchmarks.
+NetplaySession* netplay_create(int local_player, NetSocket* sock, Uint64 seed, const LevelPack* levels);
+void netplay_destroy(NetplaySession* session);
+
+// Takes in what the peer sent, rolls back if a prediction was wrong, then runs one frame
+// with `local_input` unless that would put it more than NETPLAY_MAX_PREDICTION frames past
+// the peer's inputs. Returns whether a frame ran.
+bool netplay_advance(NetplaySession* session, Uint8 local_input);
+// Takes in what the peer sent and resends our inputs, without running a frame: for
+// waiting on the peer.
+void netplay_poll(NetplaySession* session);
+
+// Goes back to the start of `frame` and runs forward again to the current one. Done by
+// netplay_poll when a prediction was wrong; public for the benchmarks.
+void netplay_rollback(NetplaySession* session, int frame);
+
+const GameState* netplay_board(const NetplaySession* session, int player);
+int netplay_local_player(const NetplaySession* session);
+int netplay_frame(const NetplaySession* session); // frames run so far
+int netplay_confirmed_frames(const NetplaySession* session); // frames run with the peer's real inputs
+NetplayStats netplay_stats(const NetplaySession* session);
+// Decided by the first frame on which a board ends, once that frame is confirmed, so both
+// peers always agree; until then NETPLAY_PLAYING, even if a board looks over.
+NetplayResult netplay_result(const NetplaySession* session);
+
+#endif
@@ -0,0 +1,257 @@
+// Headless netplay check: two scripted players play a versus game over UDP on this machine,
+// each on its own thread and at the game's fixed rate, with simulated latency, jitter and
+// packet loss in between. At the end both peers must hold the same two boards. Reports how
+// often each rolled back and how long the rollbacks took.
+// With --player, runs one side only, to pair with another process or machine.
+#include "netplay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FINISH_TIMEOUT_NS (5 * SDL_NS_PER_SECOND) // for the last inputs to arrive after the last frame
+
+typedef struct {
+    int frames;
+    Uint64 seed;
+    const LevelPack* levels;
+    NetConditions conditions;
+    const char* peer_host;
+} RunConfig;
+
+typedef struct {
+    const RunConfig* config;
+    int player;
+    Uint16 port;
+    Uint16 peer_port;
+    NetSocket* sock;
+    NetplaySession* session;
+    bool finished; // ran every frame and heard every input for them
+} Peer;
+
+typedef struct {
+    int reaction_frames;
+    int looks;
+    float target_x;
+} Bot;
+
+// Where on the paddle to meet the ball, as a fraction of its width from the center, as in
+// bricked_up_sim. Cycling through these keeps the ball out of a vertical loop.
+static const float bot_aims[] = { -0.3f, 0.1f, 0.35f, -0.15f, 0.0f, 0.25f, -0.4f };
+
+// Follows the lowest ball, looking at it every few frames, and serves when it can.
+static Uint8 bot_input(Bot* bot, const GameState* gs, int frame) {
+    float paddle_center = gs->paddle.x + gs->paddle.w / 2.0f;
+    if (frame % bot->reaction_frames == 0) {
+        float lowest = -1.0f;
+        float aim = bot_aims[(bot->looks++ / 8) % SDL_arraysize(bot_aims)] * gs->paddle.w;
+        bot->target_x = paddle_center;
+        for (int i = 0; i < gs->ball_count; i++) {
+            if (gs->balls[i].rect.y > lowest) {
+                lowest = gs->balls[i].rect.y;
+                bot->target_x = gs->balls[i].rect.x + gs->balls[i].rect.w / 2.0f - aim;
+            }
+        }
+    }
+    Uint8 input = 0;
+    if (bot->target_x < paddle_center - gs->paddle.w / 4.0f) input |= NETPLAY_INPUT_LEFT;
+    if (bot->target_x > paddle_center + gs->paddle.w / 4.0f) input |= NETPLAY_INPUT_RIGHT;
+    bool holding = !gs->ball_launched;
+    for (int i = 0; i < gs->ball_count; i++) {
+        if (gs->balls[i].is_stuck) holding = true;
+    }
+    if (holding) input |= NETPLAY_INPUT_LAUNCH;
+    return input;
+}
+
+static int run_peer(void* data) {
+    Peer* peer = data;
+    NetplaySession* session = peer->session;
+    // Different reactions, so the players' inputs differ and predictions can miss
+    Bot bot = { 4 + 3 * peer->player, 5 * peer->player, 0.0f };
+
+    Uint64 next_ns = SDL_GetTicksNS();
+    while (netplay_frame(session) < peer->config->frames) {
+        const GameState* own = netplay_board(session, peer->player);
+        Uint64 now_ns = SDL_GetTicksNS();
+        if (netplay_advance(session, bot_input(&bot, own, netplay_frame(session)))) {
+            // A step's time per frame, without catching up on time spent waiting
+            next_ns = SDL_max(next_ns + SIM_STEP_NS, now_ns);
+        } else {
+            next_ns = now_ns + SDL_NS_PER_MS;
+        }
+        now_ns = SDL_GetTicksNS();
+        if (next_ns > now_ns) SDL_DelayNS(next_ns - now_ns);
+    }
+
+    Uint64 deadline_ns = SDL_GetTicksNS() + FINISH_TIMEOUT_NS;
+    while (netplay_confirmed_frames(session) < peer->config->frames && SDL_GetTicksNS() < deadline_ns) {
+        netplay_poll(session);
+        SDL_DelayNS(4 * SDL_NS_PER_MS);
+    }
+    // Linger a little, so the peer hears our last inputs too
+    for (int i = 0; i < 25; i++) {
+        netplay_poll(session);
+        SDL_DelayNS(4 * SDL_NS_PER_MS);
+    }
+    peer->finished = netplay_confirmed_frames(session) == peer->config->frames;
+    return 0;
+}
+
+static bool open_peer(Peer* peer, const RunConfig* config, int player, Uint16 port, Uint16 peer_port) {
+    peer->config = config;
+    peer->player = player;
+    peer->port = port;
+    peer->peer_port = peer_port;
+    peer->finished = false;
+    peer->sock = net_socket_open(port, config->peer_host, peer_port, config->conditions, config->seed + 1 + player);
+    if (peer->sock == NULL) return false;
+    peer->session = netplay_create(player, peer->sock, config->seed, config->levels);
+    if (peer->session == NULL) {
+        net_socket_close(peer->sock);
+        return false;
+    }
+    return true;
+}
+
+static void close_peer(Peer* peer) {
+    netplay_destroy(peer->session);
+    net_socket_close(peer->sock);
+}
+
+static void report_peer(const Peer* peer) {
+    NetplayStats stats = netplay_stats(peer->session);
+    NetSocketStats net = net_socket_stats(peer->sock);
+    printf("player %d:\n", peer->player);
+    printf("  frames:          %llu (%llu waits on the peer)\n", (unsigned long long)stats.frames, (unsigned long long)stats.stalls);
+    printf("  rollbacks:       %llu, %.1f frames on average, %d at most\n", (unsigned long long)stats.rollbacks,
+        stats.rollbacks > 0 ? (double)stats.resimulated_frames / stats.rollbacks : 0.0, stats.max_rollback_frames);
+    printf("  rollback time:   %.3f ms mean, %.3f ms max\n",
+        stats.rollbacks > 0 ? (double)stats.rollback_ns_total / stats.rollbacks / SDL_NS_PER_MS : 0.0,
+        (double)stats.rollback_ns_max / SDL_NS_PER_MS);
+    printf("  packets:         %llu sent, %llu dropped, %llu received\n", (unsigned long long)net.sent,
+        (unsigned long long)net.dropped, (unsigned long long)net.received);
+    for (int p = 0; p < 2; p++) {
+        const GameState* gs = netplay_board(peer->session, p);
+        printf("  board %d:         %d lives, %d boards cleared, %d bricks left\n", p, gs->lives, gs->stats.boards_cleared, gs->bricks.live);
+    }
+}
+
+static void usage(const char* program) {
+    printf("Usage: %s [--frames N] [--latency-ms MS] [--jitter-ms MS] [--loss PERCENT] [--port N] [--seed N] [--levels FILE]\n", program);
+    printf("       %s --player 0|1 --port N --peer-port N [--peer HOST] [...]\n", program);
+    printf("  --frames N       frames to play, at %d per second (default 1200)\n", (int)(SDL_NS_PER_SECOND / SIM_STEP_NS));
+    printf("  --latency-ms MS  one-way delay added to every packet (default 50)\n");
+    printf("  --jitter-ms MS   up to this much more, at random (default 10)\n");
+    printf("  --loss PERCENT   packets dropped (default 5)\n");
+    printf("  --port N         UDP port of player 0; player 1 uses the next one (default 7000)\n");
+    printf("  --seed N         seed both players start from (default 1)\n");
+    printf("  --levels FILE    level pack to play (default: the built-in board)\n");
+    printf("  --player 0|1     run only this player, talking to --peer-port on --peer (default 127.0.0.1)\n");
+}
+
+int main(int argc, char* argv[]) {
+    RunConfig config;
+    int port = 7000;
+    int peer_port = -1;
+    int only_player = -1;
+    const char* levels_path = NULL;
+
+    config.frames = 1200;
+    config.seed = 1;
+    config.conditions = (NetConditions){ 50.0f, 10.0f, 0.05f };
+    config.peer_host = "127.0.0.1";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            config.frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--latency-ms") == 0 && i + 1 < argc) {
+            config.conditions.latency_ms = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--jitter-ms") == 0 && i + 1 < argc) {
+            config.conditions.jitter_ms = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--loss") == 0 && i + 1 < argc) {
+            config.conditions.loss = (float)atof(argv[++i]) / 100.0f;
+        } else if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--peer-port") == 0 && i + 1 < argc) {
+            peer_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--peer") == 0 && i + 1 < argc) {
+            config.peer_host = argv[++i];
+        } else if (strcmp(argv[i], "--player") == 0 && i + 1 < argc) {
+            only_player = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) {
+            levels_path = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    bool one_side = only_player != -1;
+    if (config.frames <= 0 || port <= 0 || port > 65534 || (one_side && (only_player < 0 || only_player > 1 || peer_port <= 0 || peer_port > 65535))) {
+        usage(argv[0]);
+        return 1;
+    }
+    LevelPack* pack = NULL;
+    if (levels_path != NULL) {
+        pack = level_pack_open(levels_path);
+        if (pack == NULL) return 1;
+    }
+    config.levels = pack != NULL ? pack : level_pack_builtin();
+
+    printf("network:         %.0f ms latency, %.0f ms jitter, %.0f%% loss\n", config.conditions.latency_ms,
+        config.conditions.jitter_ms, config.conditions.loss * 100.0f);
+    int result = 0;
+    if (one_side) {
+        Peer peer;
+        if (!open_peer(&peer, &config, only_player, (Uint16)port, (Uint16)peer_port)) {
+            level_pack_close(pack);
+            return 1;
+        }
+        run_peer(&peer);
+        report_peer(&peer);
+        for (int p = 0; p < 2; p++) {
+            printf("board %d hash:    %016llx\n", p, (unsigned long long)sim_hash(netplay_board(peer.session, p)));
+        }
+        if (!peer.finished) {
+            printf("Timed out waiting for the peer's inputs\n");
+            result = 1;
+        }
+        close_peer(&peer);
+    } else {
+        Peer peers[2];
+        if (!open_peer(&peers[0], &config, 0, (Uint16)port, (Uint16)(port + 1))) {
+            level_pack_close(pack);
+            return 1;
+        }
+        if (!open_peer(&peers[1], &config, 1, (Uint16)(port + 1), (Uint16)port)) {
+            close_peer(&peers[0]);
+            level_pack_close(pack);
+            return 1;
+        }
+        SDL_Thread* thread = SDL_CreateThread(run_peer, "player 1", &peers[1]);
+        if (thread == NULL) {
+            printf("Failed to start a thread for player 1: %s\n", SDL_GetError());
+            result = 1;
+        } else {
+            run_peer(&peers[0]);
+            SDL_WaitThread(thread, NULL);
+            report_peer(&peers[0]);
+            report_peer(&peers[1]);
+
+            bool in_sync = peers[0].finished && peers[1].finished;
+            for (int p = 0; p < 2; p++) {
+                in_sync = in_sync && sim_hash(netplay_board(peers[0].session, p)) == sim_hash(netplay_board(peers[1].session, p));
+            }
+            if (!peers[0].finished || !peers[1].finished) {
+                printf("Timed out waiting for the last inputs\n");
+            }
+            printf("result:          %s\n", in_sync ? "both peers agree on both boards" : "DESYNC");
+            result = in_sync ? 0 : 1;
+        }
+        close_peer(&peers[1]);
+        close_peer(&peers[0]);
+    }
+    level_pack_close(pack);
+    return result;
+}
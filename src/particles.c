@@ -0,0 +1,148 @@
+#include "particles.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define PARTICLE_BATCH_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PARTICLE_BATCH_WIDTH 4
+#else
+#define PARTICLE_BATCH_WIDTH 1
+#endif
+
+// Arrays are padded to a whole vector so the update can run past `count` without a tail loop
+#define PARTICLE_PADDING 8
+
+ParticleSystem* particles_create(int capacity) {
+    ParticleSystem* ps = calloc(1, sizeof(ParticleSystem));
+    if (ps == NULL) return NULL;
+
+    size_t floats = sizeof(float) * (capacity + PARTICLE_PADDING);
+    ps->x = calloc(1, floats);
+    ps->y = calloc(1, floats);
+    ps->vel_x = calloc(1, floats);
+    ps->vel_y = calloc(1, floats);
+    ps->lifetime_ms = calloc(1, floats);
+    ps->inv_start_lifetime = calloc(1, floats);
+    ps->color = calloc(capacity, sizeof(SDL_Color));
+    ps->capacity = capacity;
+    ps->rng_state = 0x5EED5EED5EED5EEDull;
+    if (ps->x == NULL || ps->y == NULL || ps->vel_x == NULL || ps->vel_y == NULL ||
+        ps->lifetime_ms == NULL || ps->inv_start_lifetime == NULL || ps->color == NULL) {
+        particles_destroy(ps);
+        return NULL;
+    }
+    return ps;
+}
+
+void particles_destroy(ParticleSystem* ps) {
+    if (ps == NULL) return;
+    free(ps->x);
+    free(ps->y);
+    free(ps->vel_x);
+    free(ps->vel_y);
+    free(ps->lifetime_ms);
+    free(ps->inv_start_lifetime);
+    free(ps->color);
+    free(ps);
+}
+
+void particles_clear(ParticleSystem* ps) {
+    ps->count = 0;
+}
+
+void particles_copy(ParticleSystem* dst, const ParticleSystem* src) {
+    int count = src->count;
+    memcpy(dst->x, src->x, sizeof(float) * count);
+    memcpy(dst->y, src->y, sizeof(float) * count);
+    memcpy(dst->vel_x, src->vel_x, sizeof(float) * count);
+    memcpy(dst->vel_y, src->vel_y, sizeof(float) * count);
+    memcpy(dst->lifetime_ms, src->lifetime_ms, sizeof(float) * count);
+    memcpy(dst->inv_start_lifetime, src->inv_start_lifetime, sizeof(float) * count);
+    memcpy(dst->color, src->color, sizeof(SDL_Color) * count);
+    dst->count = count;
+    dst->rng_state = src->rng_state;
+}
+
+// SplitMix64, as for the game's generator
+float particles_randf(ParticleSystem* ps) {
+    Uint64 z = (ps->rng_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (Uint32)((z ^ (z >> 31)) >> 40) * (1.0f / 16777216.0f);
+}
+
+void particles_spawn(ParticleSystem* ps, float x, float y, float vel_x, float vel_y, float lifetime_ms, SDL_Color color) {
+    if (ps->count == ps->capacity || lifetime_ms <= 0) return;
+
+    int i = ps->count++;
+    ps->x[i] = x;
+    ps->y[i] = y;
+    ps->vel_x[i] = vel_x;
+    ps->vel_y[i] = vel_y;
+    ps->lifetime_ms[i] = lifetime_ms;
+    ps->inv_start_lifetime[i] = 1.0f / lifetime_ms;
+    ps->color[i] = color;
+}
+
+void particles_burst(ParticleSystem* ps, SDL_FRect rect, int count, float speed, float lifetime_ms, SDL_Color color) {
+    for (int i = 0; i < count; i++) {
+        float angle = particles_randf(ps) * 2.0f * (float)M_PI;
+        float particle_speed = speed * (0.3f + 0.7f * particles_randf(ps));
+        float particle_lifetime = lifetime_ms * (0.5f + 0.5f * particles_randf(ps));
+        particles_spawn(ps,
+            rect.x + particles_randf(ps) * rect.w,
+            rect.y + particles_randf(ps) * rect.h,
+            cosf(angle) * particle_speed,
+            sinf(angle) * particle_speed,
+            particle_lifetime, color);
+    }
+}
+
+void particles_update(ParticleSystem* ps, float delta_ms) {
+    int count = ps->count;
+    int i = 0;
+
+#if PARTICLE_BATCH_WIDTH == 8
+    __m256 dt = _mm256_set1_ps(delta_ms);
+    for (; i < count; i += 8) {
+        _mm256_storeu_ps(ps->x + i, _mm256_add_ps(_mm256_loadu_ps(ps->x + i), _mm256_mul_ps(_mm256_loadu_ps(ps->vel_x + i), dt)));
+        _mm256_storeu_ps(ps->y + i, _mm256_add_ps(_mm256_loadu_ps(ps->y + i), _mm256_mul_ps(_mm256_loadu_ps(ps->vel_y + i), dt)));
+        _mm256_storeu_ps(ps->lifetime_ms + i, _mm256_sub_ps(_mm256_loadu_ps(ps->lifetime_ms + i), dt));
+    }
+#elif PARTICLE_BATCH_WIDTH == 4
+    __m128 dt = _mm_set1_ps(delta_ms);
+    for (; i < count; i += 4) {
+        _mm_storeu_ps(ps->x + i, _mm_add_ps(_mm_loadu_ps(ps->x + i), _mm_mul_ps(_mm_loadu_ps(ps->vel_x + i), dt)));
+        _mm_storeu_ps(ps->y + i, _mm_add_ps(_mm_loadu_ps(ps->y + i), _mm_mul_ps(_mm_loadu_ps(ps->vel_y + i), dt)));
+        _mm_storeu_ps(ps->lifetime_ms + i, _mm_sub_ps(_mm_loadu_ps(ps->lifetime_ms + i), dt));
+    }
+#else
+    for (; i < count; i++) {
+        ps->x[i] += ps->vel_x[i] * delta_ms;
+        ps->y[i] += ps->vel_y[i] * delta_ms;
+        ps->lifetime_ms[i] -= delta_ms;
+    }
+#endif
+
+    // Swap-remove the dead; the particle moved into slot i hasn't been checked yet
+    i = 0;
+    while (i < count) {
+        if (ps->lifetime_ms[i] > 0) {
+            i++;
+            continue;
+        }
+        count--;
+        ps->x[i] = ps->x[count];
+        ps->y[i] = ps->y[count];
+        ps->vel_x[i] = ps->vel_x[count];
+        ps->vel_y[i] = ps->vel_y[count];
+        ps->lifetime_ms[i] = ps->lifetime_ms[count];
+        ps->inv_start_lifetime[i] = ps->inv_start_lifetime[count];
+        ps->color[i] = ps->color[count];
+    }
+    ps->count = count;
+}
@@ -0,0 +1,46 @@
+#ifndef BRICKED_UP_PARTICLES_H
+#define BRICKED_UP_PARTICLES_H
+
+// Cosmetic particles: brick debris, ball trails and the sticky paddle's force field.
+// Live particles are packed into [0, count) of structure-of-arrays storage, so spawning
+// appends, dying swaps the last particle into the hole, and the update streams through
+// dense arrays with SIMD. Particles draw from their own generator and never feed back
+// into the game, so they can be left out of headless runs, hashes and replays.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#define PARTICLE_CAPACITY 32768
+
+typedef struct ParticleSystem {
+    float* x;
+    float* y;
+    float* vel_x; // pixels per ms
+    float* vel_y;
+    float* lifetime_ms; // remaining
+    float* inv_start_lifetime; // 1 / lifetime at spawn, so alpha is lifetime_ms * this
+    SDL_Color* color;
+    int count;
+    int capacity;
+    Uint64 rng_state;
+} ParticleSystem;
+
+ParticleSystem* particles_create(int capacity);
+void particles_destroy(ParticleSystem* ps);
+void particles_clear(ParticleSystem* ps);
+
+// Copies the live particles of `src` into `dst`, which needs at least the same capacity.
+void particles_copy(ParticleSystem* dst, const ParticleSystem* src);
+
+// Uniform in [0, 1) from the particle generator
+float particles_randf(ParticleSystem* ps);
+
+// Drops the particle if the system is full.
+void particles_spawn(ParticleSystem* ps, float x, float y, float vel_x, float vel_y, float lifetime_ms, SDL_Color color);
+
+// `count` particles flying out of `rect` in every direction.
+void particles_burst(ParticleSystem* ps, SDL_FRect rect, int count, float speed, float lifetime_ms, SDL_Color color);
+
+void particles_update(ParticleSystem* ps, float delta_ms);
+
+#endif
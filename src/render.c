@@ -0,0 +1,579 @@
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "app.h"
+
+void draw_filled_circle(SDL_Renderer* renderer, float center_x, float center_y, float radius) {
+    for (float y = -radius; y <= radius; y++) {
+        for (float x = -radius; x <= radius; x++) {
+            if (x * x + y * y <= radius * radius) {
+                SDL_RenderPoint(renderer, center_x + x, center_y + y);
+            }
+        }
+    }
+}
+
+void draw_rounded_rect(SDL_Renderer* renderer, SDL_FRect* rect, float radius) {
+    float x = rect->x;
+    float y = rect->y;
+    float w = rect->w;
+    float h = rect->h;
+
+    SDL_FRect body = {x + radius, y, w - 2 * radius, h};
+    SDL_RenderFillRect(renderer, &body);
+    SDL_FRect body2 = {x, y + radius, w, h - 2 * radius};
+    SDL_RenderFillRect(renderer, &body2);
+
+    draw_filled_circle(renderer, x + radius, y + radius, radius);
+    draw_filled_circle(renderer, x + w - radius, y + radius, radius);
+    draw_filled_circle(renderer, x + radius, y + h - radius, radius);
+    draw_filled_circle(renderer, x + w - radius, y + h - radius, radius);
+}
+
+// Atlas cell for a power-up type: the icon with a pixel of margin all round, since its
+// lines reach one pixel past the power-up's rect.
+static SDL_FRect powerup_atlas_rect(PowerUpType type) {
+    SDL_FRect cell = { (float)(type * POWERUP_ATLAS_CELL), 0, POWERUP_ATLAS_CELL, POWERUP_ATLAS_CELL };
+    return cell;
+}
+
+// The per-pixel drawing behind each power-up icon; only used to fill the atlas.
+static void draw_powerup_icon(SDL_Renderer* renderer, SDL_FRect rect, PowerUpType type) {
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    draw_rounded_rect(renderer, &rect, 3);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    float line_thickness = POWERUP_SIZE / 5.0f;
+    if (type == POWERUP_ADD_LIFE) {
+        SDL_FRect h_line = {rect.x, rect.y + (POWERUP_SIZE / 2.0f) - (line_thickness / 2.0f), POWERUP_SIZE, line_thickness};
+        SDL_FRect v_line = {rect.x + (POWERUP_SIZE / 2.0f) - (line_thickness / 2.0f), rect.y, line_thickness, POWERUP_SIZE};
+        SDL_RenderFillRect(renderer, &h_line);
+        SDL_RenderFillRect(renderer, &v_line);
+    } else if (type == POWERUP_REMOVE_LIFE) {
+        SDL_FRect h_line = {rect.x, rect.y + (POWERUP_SIZE / 2.0f) - (line_thickness / 2.0f), POWERUP_SIZE, line_thickness};
+        SDL_RenderFillRect(renderer, &h_line);
+    } else if (type == POWERUP_PADDLE_WIDER) {
+        SDL_RenderLine(renderer, rect.x, rect.y, rect.x + rect.w, rect.y + rect.h / 2);
+        SDL_RenderLine(renderer, rect.x + rect.w, rect.y + rect.h / 2, rect.x, rect.y + rect.h);
+    } else if (type == POWERUP_PADDLE_NARROWER) {
+        SDL_RenderLine(renderer, rect.x + rect.w, rect.y, rect.x, rect.y + rect.h / 2);
+        SDL_RenderLine(renderer, rect.x, rect.y + rect.h / 2, rect.x + rect.w, rect.y + rect.h);
+    } else if (type == POWERUP_BALL_SPLIT) {
+        float cx = rect.x + POWERUP_SIZE / 2;
+        float cy = rect.y + POWERUP_SIZE / 2;
+        float r = POWERUP_SIZE / 2;
+        SDL_RenderLine(renderer, cx, cy - r, cx, cy + r);
+        SDL_RenderLine(renderer, cx - r, cy, cx + r, cy);
+        SDL_RenderLine(renderer, cx - r, cy - r, cx + r, cy + r);
+        SDL_RenderLine(renderer, cx - r, cy + r, cx + r, cy - r);
+    } else if (type == POWERUP_STICKY_PADDLE) {
+        float x = rect.x;
+        float y = rect.y;
+        float w = rect.w;
+        float h = rect.h;
+        SDL_RenderLine(renderer, x + w/4, y, x + w/4, y + h);
+        SDL_RenderLine(renderer, x + 3*w/4, y, x + 3*w/4, y + h);
+        SDL_RenderLine(renderer, x, y + h/4, x + w, y + h/4);
+        SDL_RenderLine(renderer, x, y + 3*h/4, x + w, y + 3*h/4);
+    }
+}
+
+// Rasterizes every PowerUpType icon once into a row of atlas cells.
+static SDL_Texture* create_powerup_atlas(SDL_Renderer* renderer) {
+    SDL_Texture* atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+        POWERUP_ATLAS_CELL * POWERUP_TYPE_COUNT, POWERUP_ATLAS_CELL);
+    if (atlas == NULL) return NULL;
+    SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+
+    SDL_SetRenderTarget(renderer, atlas);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    for (int type = 0; type < POWERUP_TYPE_COUNT; type++) {
+        SDL_FRect cell = powerup_atlas_rect(type);
+        SDL_FRect icon = { cell.x + 1, cell.y + 1, POWERUP_SIZE, POWERUP_SIZE };
+        draw_powerup_icon(renderer, icon, type);
+    }
+    SDL_SetRenderTarget(renderer, NULL);
+    return atlas;
+}
+
+bool render_init(App* app) {
+    app->powerup_atlas = create_powerup_atlas(app->renderer);
+    if (app->powerup_atlas == NULL) {
+        printf("Failed to create power-up atlas: %s\n", SDL_GetError());
+        return false;
+    }
+    if (!sprite_batch_init(&app->powerup_sprites, app->renderer, app->powerup_atlas)) {
+        return false;
+    }
+    SDL_FRect screen = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+    SDL_FRect playfield = {0, TOP_MARGIN, SCREEN_WIDTH, SCREEN_HEIGHT - TOP_MARGIN};
+    if (!render_layer_init(&app->background_layer, app->renderer, screen, true) ||
+        !render_layer_init(&app->brick_layer, app->renderer, playfield, false)) {
+        return false;
+    }
+    app->particles = particles_create(PARTICLE_CAPACITY);
+    if (app->particles == NULL) {
+        printf("Failed to allocate particles\n");
+        return false;
+    }
+    return sprite_batch_init(&app->particle_quads, app->renderer, NULL);
+}
+
+bool render_attach_assets(App* app) {
+    return sprite_batch_init(&app->sprites, app->renderer, app->spritesheet) &&
+        text_cache_upload(&app->text, app->renderer);
+}
+
+void render_shutdown(App* app) {
+    text_cache_destroy(&app->text);
+    sprite_batch_destroy(&app->particle_quads);
+    render_layer_destroy(&app->brick_layer);
+    render_layer_destroy(&app->background_layer);
+    particles_destroy(app->particles);
+    app->particles = NULL;
+    sprite_batch_destroy(&app->powerup_sprites);
+    sprite_batch_destroy(&app->sprites);
+    if (app->powerup_atlas != NULL) {
+        SDL_DestroyTexture(app->powerup_atlas);
+        app->powerup_atlas = NULL;
+    }
+}
+
+// Debug overlay: p50/p99/max per phase over the last FRAME_HISTORY frames, and a graph of
+// recent frames with each bar split into events, update, render, present and idle time.
+void render_frame_stats(App* app) {
+    const FrameStats* stats = &app->frame_stats;
+    const SDL_Color phase_colors[FRAME_PHASE_COUNT] = {
+        {80, 140, 255, 255}, // events
+        {80, 220, 100, 255}, // update
+        {255, 160, 60, 255}, // render
+        {200, 90, 220, 255}  // present
+    };
+    const float graph_x = 5;
+    const float graph_h = 60;
+    const float graph_y = SCREEN_HEIGHT - 35 - graph_h;
+    const float px_per_ms = graph_h / 33.0f;
+    const float line_h = 20;
+    FrameSummary summaries[FRAME_PHASE_COUNT + 1];
+    FrameSummary latency;
+
+    frame_stats_summarize(stats, summaries);
+    int latency_count = frame_stats_summarize_latency(stats, &latency);
+
+    SDL_SetRenderDrawBlendMode(app->renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(app->renderer, 0, 0, 0, 170);
+    SDL_FRect background = {0, graph_y - (FRAME_PHASE_COUNT + 3) * line_h - 10, FRAME_HISTORY + 170, (FRAME_PHASE_COUNT + 3) * line_h + graph_h + 15};
+    SDL_RenderFillRect(app->renderer, &background);
+
+    for (int i = 0; i < stats->history_count; i++) {
+        const FrameTiming* frame = frame_stats_recent(stats, i);
+        float x = graph_x + FRAME_HISTORY - 1 - i;
+        float y = graph_y + graph_h;
+        float busy_ms = 0.0f;
+        for (int p = 0; p < FRAME_PHASE_COUNT; p++) {
+            float h = frame->phase_ns[p] / 1e6f * px_per_ms;
+            busy_ms += frame->phase_ns[p] / 1e6f;
+            SDL_SetRenderDrawColor(app->renderer, phase_colors[p].r, phase_colors[p].g, phase_colors[p].b, 255);
+            SDL_RenderLine(app->renderer, x, y, x, y - h);
+            y -= h;
+        }
+        float idle_h = (frame->frame_ns / 1e6f - busy_ms) * px_per_ms;
+        SDL_SetRenderDrawColor(app->renderer, 90, 90, 90, 255);
+        SDL_RenderLine(app->renderer, x, y, x, SDL_max(graph_y, y - idle_h));
+    }
+
+    // Frame budget at the pacer's target rate
+    float budget_y = graph_y + graph_h - app->pacer.period_ns / 1e6f * px_per_ms;
+    SDL_SetRenderDrawColor(app->renderer, 255, 60, 60, 255);
+    SDL_RenderLine(app->renderer, graph_x, budget_y, graph_x + FRAME_HISTORY, budget_y);
+
+    char pacing[80];
+    snprintf(pacing, sizeof(pacing), "%s %.0f Hz, missed %llu of %llu", pacing_mode_names[app->pacer.mode], app->pacer.target_hz,
+        (unsigned long long)app->pacer.missed, (unsigned long long)app->pacer.frames);
+    text_queue(&app->text, pacing, graph_x, graph_y - (FRAME_PHASE_COUNT + 3) * line_h - 5, (SDL_Color){255, 255, 255, 255}, 0.75f);
+
+    char input_line[80];
+    snprintf(input_line, sizeof(input_line), "input   p50 %5.2f p99 %5.2f max %6.2f (%d)", latency.p50_ms, latency.p99_ms, latency.max_ms, latency_count);
+    text_queue(&app->text, input_line, graph_x, graph_y - (FRAME_PHASE_COUNT + 2) * line_h - 5, (SDL_Color){255, 255, 255, 255}, 0.75f);
+
+    for (int p = 0; p <= FRAME_PHASE_COUNT; p++) {
+        char line[80];
+        SDL_Color color = p < FRAME_PHASE_COUNT ? phase_colors[p] : (SDL_Color){255, 255, 255, 255};
+        snprintf(line, sizeof(line), "%-7s p50 %5.2f p99 %5.2f max %6.2f", p < FRAME_PHASE_COUNT ? frame_phase_names[p] : "frame",
+            summaries[p].p50_ms, summaries[p].p99_ms, summaries[p].max_ms);
+        text_queue(&app->text, line, graph_x, graph_y - (FRAME_PHASE_COUNT + 1 - p) * line_h - 5, color, 0.75f);
+    }
+    text_flush(&app->text);
+}
+
+// Balls that move with the paddle: stuck to it, or waiting to be launched
+static bool ball_on_paddle(const GameState* gs, int i) {
+    return gs->balls[i].is_stuck || (i == 0 && !gs->ball_launched);
+}
+
+static void add_brick_sprite(SpriteBatch* sprites, const GameState* gs, int index, float offset_x, float offset_y) {
+    SDL_FRect rect = brick_rect(&gs->bricks, index);
+    rect.x -= offset_x;
+    rect.y -= offset_y;
+    int frame = gs->bricks.animation_frame[index];
+    int src_x = 32 + (frame * 32);
+    int src_y = 176 + gs->bricks.sprite_row[index] * 16;
+    SDL_FRect src_rect = { src_x, src_y, 32, 16 };
+    sprite_batch_add(sprites, &src_rect, &rect, SDL_FLIP_NONE);
+}
+
+
+// Black background, borders and the lives display, redrawn when the lives change
+static void update_background_layer(App* app) {
+    const GameState* gs = app->view;
+    RenderLayer* layer = &app->background_layer;
+    if (layer->valid && app->background_lives == gs->lives) return;
+
+    render_layer_begin(layer);
+    SDL_SetRenderDrawColor(app->renderer, 192, 192, 192, 255);
+    SDL_FRect top_border = {0, TOP_MARGIN - BORDER_THICKNESS, SCREEN_WIDTH, BORDER_THICKNESS};
+    SDL_RenderFillRect(app->renderer, &top_border);
+    SDL_FRect left_border = {0, 0, BORDER_THICKNESS, SCREEN_HEIGHT};
+    SDL_RenderFillRect(app->renderer, &left_border);
+    SDL_FRect right_border = {SCREEN_WIDTH - BORDER_THICKNESS, 0, BORDER_THICKNESS, SCREEN_HEIGHT};
+    SDL_RenderFillRect(app->renderer, &right_border);
+
+    SDL_FRect ball_src_rect = { 50, 34, 12, 12 };
+    int balls_per_col = (TOP_MARGIN - 2 * BORDER_THICKNESS) / (BALL_SIZE + 3);
+    for (int i = 0; i < gs->lives; i++) {
+        int col = i / balls_per_col;
+        int row = i % balls_per_col;
+        SDL_FRect life_ball = {
+            SCREEN_WIDTH - BORDER_THICKNESS - 5 - (col + 1) * (BALL_SIZE + 3) + 3,
+            BORDER_THICKNESS + 5 + row * (BALL_SIZE + 3),
+            BALL_SIZE,
+            BALL_SIZE
+        };
+        sprite_batch_add(&app->sprites, &ball_src_rect, &life_ball, SDL_FLIP_NONE);
+    }
+    sprite_batch_flush(&app->sprites);
+    render_layer_end(layer);
+    app->background_lives = gs->lives;
+}
+
+// The settled bricks (solid, not yet hit), redrawn when a brick gets hit or the layout
+// changes (a new board or game, a rewind), even if the same bricks are solid
+static void update_brick_layer(App* app) {
+    const GameState* gs = app->view;
+    RenderLayer* layer = &app->brick_layer;
+    size_t size = sizeof(Uint64) * BITSET_WORDS(gs->bricks.count);
+    if (layer->valid && app->brick_layer_layout_id == gs->bricks.layout_id &&
+        memcmp(app->brick_layer_settled, gs->bricks.collidable, size) == 0) return;
+    memcpy(app->brick_layer_settled, gs->bricks.collidable, size);
+    app->brick_layer_layout_id = gs->bricks.layout_id;
+
+    render_layer_begin(layer);
+    for (int w = 0; w < BITSET_WORDS(gs->bricks.count); w++) {
+        for (Uint64 bits = app->brick_layer_settled[w]; bits != 0; bits &= bits - 1) {
+            add_brick_sprite(&app->sprites, gs, w * 64 + bitset_ctz(bits), layer->rect.x, layer->rect.y);
+        }
+    }
+    sprite_batch_flush(&app->sprites);
+    render_layer_end(layer);
+}
+
+void render_invalidate_layers(App* app) {
+    app->background_layer.valid = false;
+    app->brick_layer.valid = false;
+}
+
+// `alpha` is how far the frame sits between the previous and the current simulation step.
+void render_gameplay(App* app, float alpha) {
+    const GameState* gs = app->view;
+    float scale = 2.0f;
+    bool show_collisions = app->debug_mode && app->debug_render_collisions;
+
+    // The opaque background layer covers the whole screen, so it stands in for a clear
+    update_background_layer(app);
+    if (!show_collisions) update_brick_layer(app);
+    render_layer_draw(&app->background_layer);
+
+    if (!gs->ball_launched && !gs->paused) {
+        SDL_Color white = {255, 255, 255, 255};
+        SDL_Color gray = {192, 192, 192, 255};
+
+        const char* text1 = "USE ";
+        const char* text2 = "ARROWS";
+        const char* text3 = " TO MOVE AND ";
+        const char* text4 = "SPACE";
+        const char* text5 = " TO SHOOT";
+
+        TextCache* text = &app->text;
+        float total_width = text_width(text, text1, 1.0f) + text_width(text, text2, 1.0f) + text_width(text, text3, 1.0f) +
+            text_width(text, text4, 1.0f) + text_width(text, text5, 1.0f);
+        float current_x = (SCREEN_WIDTH - total_width) / 2.0f;
+        float y = TOP_MARGIN + (SCREEN_HEIGHT - TOP_MARGIN - text_height(text, 1.0f)) / 2.0f + 80.0f;
+
+        current_x = text_queue(text, text1, current_x, y, gray, 1.0f);
+        current_x = text_queue(text, text2, current_x, y, white, 1.0f);
+        current_x = text_queue(text, text3, current_x, y, gray, 1.0f);
+        current_x = text_queue(text, text4, current_x, y, white, 1.0f);
+        text_queue(text, text5, current_x, y, gray, 1.0f);
+        text_flush(text);
+    }
+
+    if (!show_collisions) render_layer_draw(&app->brick_layer);
+
+    // Everything else that samples the spritesheet goes into one batch, submitted below. The
+    // paddle and the balls resting on it are left to render_paddle.
+    SpriteBatch* sprites = &app->sprites;
+
+    // Chaos mode can have thousands of balls, so collision boxes go out in chunks
+    SDL_FRect ball_src_rect = { 50, 34, 12, 12 };
+    SDL_FRect ball_boxes[256];
+    int ball_box_count = 0;
+    if (show_collisions) SDL_SetRenderDrawColor(app->renderer, 0, 255, 0, 255);
+    for (int i = 0; i < gs->ball_count; i++) {
+        if (!ball_on_paddle(gs, i)) {
+            SDL_FRect ball_rect = gs->balls[i].rect;
+            ball_rect.x = gs->balls[i].prev_pos.x + (gs->balls[i].rect.x - gs->balls[i].prev_pos.x) * alpha;
+            ball_rect.y = gs->balls[i].prev_pos.y + (gs->balls[i].rect.y - gs->balls[i].prev_pos.y) * alpha;
+            if (show_collisions) {
+                ball_boxes[ball_box_count++] = ball_rect;
+                if (ball_box_count == (int)SDL_arraysize(ball_boxes)) {
+                    SDL_RenderFillRects(app->renderer, ball_boxes, ball_box_count);
+                    ball_box_count = 0;
+                }
+            } else {
+                sprite_batch_add(sprites, &ball_src_rect, &ball_rect, SDL_FLIP_NONE);
+            }
+        }
+    }
+
+    // Bricks that are breaking animate every frame, so they skip the brick layer
+    if (!show_collisions) {
+        for (int w = 0; w < BITSET_WORDS(gs->bricks.count) && gs->bricks.animating_count > 0; w++) {
+            for (Uint64 bits = gs->bricks.animating[w]; bits != 0; bits &= bits - 1) {
+                add_brick_sprite(sprites, gs, w * 64 + bitset_ctz(bits), 0, 0);
+            }
+        }
+    }
+
+    sprite_batch_flush(sprites);
+
+    if (show_collisions) {
+        SDL_RenderFillRects(app->renderer, ball_boxes, ball_box_count);
+
+        // Boards can hold tens of thousands of bricks, so their boxes go out in chunks
+        SDL_FRect brick_boxes[256];
+        int brick_box_count = 0;
+        SDL_SetRenderDrawColor(app->renderer, 0, 0, 255, 255);
+        for (int w = 0; w < BITSET_WORDS(gs->bricks.count); w++) {
+            for (Uint64 bits = gs->bricks.alive[w]; bits != 0; bits &= bits - 1) {
+                brick_boxes[brick_box_count++] = brick_rect(&gs->bricks, w * 64 + bitset_ctz(bits));
+                if (brick_box_count == (int)SDL_arraysize(brick_boxes)) {
+                    SDL_RenderFillRects(app->renderer, brick_boxes, brick_box_count);
+                    brick_box_count = 0;
+                }
+            }
+        }
+        SDL_RenderFillRects(app->renderer, brick_boxes, brick_box_count);
+    }
+
+    // Draw particles, fading out over their lifetime
+    const ParticleSystem* ps = gs->particles;
+    if (ps != NULL) {
+        for (int i = 0; i < ps->count; i++) {
+            SDL_Color c = ps->color[i];
+            float fade = ps->lifetime_ms[i] * ps->inv_start_lifetime[i];
+            SDL_FColor color = {c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f * fade};
+            SDL_FRect particle_rect = { ps->x[i], ps->y[i], scale, scale };
+            sprite_batch_add_rect(&app->particle_quads, &particle_rect, color);
+        }
+        sprite_batch_flush(&app->particle_quads);
+    }
+
+    // Draw powerups
+    for (int i = 0; i < MAX_POWERUPS; i++) {
+        if (gs->powerups[i].active) {
+            SDL_FRect rect = gs->powerups[i].rect;
+            rect.y = gs->powerups[i].prev_y + (rect.y - gs->powerups[i].prev_y) * alpha;
+            SDL_FRect src = powerup_atlas_rect(gs->powerups[i].type);
+            SDL_FRect dest = { rect.x - 1, rect.y - 1, rect.w + 2, rect.h + 2 };
+            sprite_batch_add(&app->powerup_sprites, &src, &dest, SDL_FLIP_NONE);
+        }
+    }
+    sprite_batch_flush(&app->powerup_sprites);
+
+    SDL_Color text_color = {255, 255, 255, 255};
+    if (gs->paused) {
+        text_queue(&app->text, "PAUSED",
+            (SCREEN_WIDTH - text_width(&app->text, "PAUSED", 1.0f)) / 2.0f,
+            (SCREEN_HEIGHT - text_height(&app->text, 1.0f)) / 2.0f,
+            text_color, 1.0f);
+    }
+
+    if (app->show_speed_timer_ns > 0) {
+        char speed_text[20];
+        snprintf(speed_text, 20, "SPEED %.0f%%", gs->game_speed * 100);
+        text_queue(&app->text, speed_text,
+            (SCREEN_WIDTH - text_width(&app->text, speed_text, 1.0f)) / 2.0f,
+            (SCREEN_HEIGHT - text_height(&app->text, 1.0f)) / 2.0f + 30,
+            text_color, 1.0f);
+    }
+
+    if (app->netplay != NULL) {
+        const GameState* opponent = netplay_board(app->netplay, 1 - app->versus_player);
+        char versus_text[48];
+        snprintf(versus_text, sizeof(versus_text), "OPPONENT LIVES %d  BOARDS %d", opponent->lives, opponent->level);
+        text_queue(&app->text, versus_text, SCREEN_WIDTH - text_width(&app->text, versus_text, 1.0f) - 5,
+            SCREEN_HEIGHT - text_height(&app->text, 1.0f) - 5, text_color, 1.0f);
+    }
+
+    if (app->debug_mode) {
+        text_queue(&app->text, "DEBUG", 5, SCREEN_HEIGHT - text_height(&app->text, 1.0f) - 5, text_color, 1.0f);
+        render_frame_stats(app);
+    }
+    text_flush(&app->text);
+}
+
+void render_paddle(App* app, float alpha, float paddle_x) {
+    const GameState* gs = app->view;
+    float scale = 2.0f;
+    SDL_FRect paddle = gs->paddle;
+    paddle.x = paddle_x;
+    // Balls on the paddle keep their offset from it
+    float shift_x = paddle_x - (gs->prev_paddle_x + (gs->paddle.x - gs->prev_paddle_x) * alpha);
+
+    SpriteBatch* sprites = &app->sprites;
+    bool show_collisions = app->debug_mode && app->debug_render_collisions;
+    bool is_sticky_paddle_active = gs->sticky_paddle_timer_ns > 0;
+    SDL_FRect sticky_dest_left = { paddle.x - 13, paddle.y - 5, 12 * scale, 16 * scale };
+    SDL_FRect sticky_dest_right = { paddle.x + paddle.w - 10, paddle.y - 5, 12 * scale, 16 * scale };
+
+    // Draw paddle
+    if (show_collisions) {
+        SDL_SetRenderDrawColor(app->renderer, 255, 0, 0, 255);
+        SDL_RenderFillRect(app->renderer, &paddle);
+    } else {
+        SDL_FRect left_paddle_src = { 112, 48, 6, 14 };
+        SDL_FRect right_paddle_src = { 138, 48, 6, 14 };
+        SDL_FRect middle_paddle_src = { 118, 50, 20, 10 };
+
+        float left_w = left_paddle_src.w * scale;
+        float right_w = right_paddle_src.w * scale;
+        float middle_h = middle_paddle_src.h * scale;
+
+        SDL_FRect left_paddle_dest = { paddle.x, paddle.y - 4, left_w, 28 };
+        SDL_FRect right_paddle_dest = { paddle.x + paddle.w - right_w, paddle.y - 4, right_w, 28 };
+        SDL_FRect middle_paddle_dest = { paddle.x + left_w, paddle.y + (PADDLE_HEIGHT - middle_h) / 2.0f, paddle.w - left_w - right_w, middle_h };
+
+        sprite_batch_add(sprites, &left_paddle_src, &left_paddle_dest, SDL_FLIP_NONE);
+        sprite_batch_add(sprites, &right_paddle_src, &right_paddle_dest, SDL_FLIP_NONE);
+        sprite_batch_add(sprites, &middle_paddle_src, &middle_paddle_dest, SDL_FLIP_NONE);
+
+        if (is_sticky_paddle_active) {
+            SDL_FRect sticky_src = { 132, 16, 12, 16 };
+            sprite_batch_add(sprites, &sticky_src, &sticky_dest_left, SDL_FLIP_NONE);
+            sprite_batch_add(sprites, &sticky_src, &sticky_dest_right, SDL_FLIP_HORIZONTAL);
+        }
+    }
+
+    SDL_FRect ball_src_rect = { 50, 34, 12, 12 };
+    for (int i = 0; i < gs->ball_count; i++) {
+        if (ball_on_paddle(gs, i)) {
+            SDL_FRect ball_rect = gs->balls[i].rect;
+            ball_rect.x = gs->balls[i].prev_pos.x + (gs->balls[i].rect.x - gs->balls[i].prev_pos.x) * alpha + shift_x;
+            ball_rect.y = gs->balls[i].prev_pos.y + (gs->balls[i].rect.y - gs->balls[i].prev_pos.y) * alpha;
+            if (show_collisions) {
+                SDL_SetRenderDrawColor(app->renderer, 0, 255, 0, 255);
+                SDL_RenderFillRect(app->renderer, &ball_rect);
+            } else {
+                sprite_batch_add(sprites, &ball_src_rect, &ball_rect, SDL_FLIP_NONE);
+            }
+        }
+    }
+    sprite_batch_flush(sprites);
+
+    if (is_sticky_paddle_active && !show_collisions) {
+        // Draw force field
+        float left_x = sticky_dest_left.x + sticky_dest_left.w / 2;
+        float right_x = sticky_dest_right.x + sticky_dest_right.w / 2;
+        float y = sticky_dest_left.y + 2 + gs->force_field_y_offset;
+
+        Uint8 r = 100 + sinf(gs->force_field_anim_timer / 150.0f) * 50;
+        Uint8 g = 150 + sinf(gs->force_field_anim_timer / 180.0f) * 50;
+        SDL_SetRenderDrawColor(app->renderer, r, g, 255, 150);
+        SDL_RenderLine(app->renderer, left_x, y, right_x, y);
+        SDL_RenderLine(app->renderer, left_x, y+1, right_x, y+1);
+    }
+}
+
+// Title screen for the frames before the font is ready, in SDL's built-in debug font
+static void render_loading_title(App* app) {
+    const char* title = "Bricked Up";
+    const char* status = app->start_requested ? "Starting..." : "Loading...";
+    float glyph = SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE;
+
+    SDL_SetRenderDrawColor(app->renderer, 255, 255, 255, 255);
+    SDL_SetRenderScale(app->renderer, 3.0f, 3.0f);
+    SDL_RenderDebugText(app->renderer, (SCREEN_WIDTH / 3.0f - strlen(title) * glyph) / 2.0f, (SCREEN_HEIGHT / 3.0f) / 2.0f - glyph, title);
+    SDL_SetRenderScale(app->renderer, 1.0f, 1.0f);
+    SDL_RenderDebugText(app->renderer, (SCREEN_WIDTH - strlen(status) * glyph) / 2.0f, SCREEN_HEIGHT / 2.0f + 2.0f * glyph, status);
+}
+
+void render_title_screen(App* app) {
+    SDL_SetRenderDrawColor(app->renderer, 0, 0, 0, 255);
+    SDL_RenderClear(app->renderer);
+    if (!app->assets_ready) {
+        render_loading_title(app);
+        return;
+    }
+
+    SDL_Color text_color = {255, 255, 255, 255};
+    const StaticText* title = text_static(&app->text, "Bricked Up", text_color, true);
+    SDL_FRect title_rect = {
+        (SCREEN_WIDTH - title->w) / 2.0f,
+        (SCREEN_HEIGHT / 2.0f) - title->h,
+        title->w,
+        title->h
+    };
+    SDL_RenderTexture(app->renderer, title->texture, NULL, &title_rect);
+
+    const StaticText* instruction = text_static(&app->text, "Press Enter to Start", text_color, true);
+    SDL_FRect instruction_rect = {
+        (SCREEN_WIDTH - instruction->w) / 2.0f,
+        (SCREEN_HEIGHT / 2.0f) + instruction->h,
+        instruction->w,
+        instruction->h
+    };
+    SDL_RenderTexture(app->renderer, instruction->texture, NULL, &instruction_rect);
+}
+
+void render_game_over_screen(App* app) {
+    SDL_SetRenderDrawColor(app->renderer, 0, 0, 0, 255);
+    SDL_RenderClear(app->renderer);
+
+    SDL_Color text_color = {255, 255, 255, 255};
+    const char* title_text = "Game Over";
+    if (app->netplay != NULL) {
+        NetplayResult result = netplay_result(app->netplay);
+        title_text = result == NETPLAY_DRAW ? "Draw" : result == (app->versus_player == 0 ? NETPLAY_WON_BY_0 : NETPLAY_WON_BY_1) ? "You Win" : "You Lose";
+    }
+    const StaticText* title = text_static(&app->text, title_text, text_color, true);
+    SDL_FRect title_rect = {
+        (SCREEN_WIDTH - title->w) / 2.0f,
+        (SCREEN_HEIGHT / 2.0f) - title->h,
+        title->w,
+        title->h
+    };
+    SDL_RenderTexture(app->renderer, title->texture, NULL, &title_rect);
+
+    const StaticText* instruction = text_static(&app->text, app->netplay != NULL ? "Press Enter to Quit" : "Press Enter to Return to Title",
+        text_color, true);
+    SDL_FRect instruction_rect = {
+        (SCREEN_WIDTH - instruction->w) / 2.0f,
+        (SCREEN_HEIGHT / 2.0f) + instruction->h,
+        instruction->w,
+        instruction->h
+    };
+    SDL_RenderTexture(app->renderer, instruction->texture, NULL, &instruction_rect);
+}
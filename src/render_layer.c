@@ -0,0 +1,38 @@
+#include "render_layer.h"
+#include <stdio.h>
+#include <string.h>
+
+bool render_layer_init(RenderLayer* layer, SDL_Renderer* renderer, SDL_FRect rect, bool opaque) {
+    memset(layer, 0, sizeof(RenderLayer));
+    layer->renderer = renderer;
+    layer->rect = rect;
+    layer->opaque = opaque;
+    layer->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, (int)rect.w, (int)rect.h);
+    if (layer->texture == NULL) {
+        printf("Failed to create render layer: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(layer->texture, opaque ? SDL_BLENDMODE_NONE : SDL_BLENDMODE_BLEND);
+    SDL_SetTextureScaleMode(layer->texture, SDL_SCALEMODE_NEAREST);
+    return true;
+}
+
+void render_layer_destroy(RenderLayer* layer) {
+    if (layer->texture != NULL) SDL_DestroyTexture(layer->texture);
+    memset(layer, 0, sizeof(RenderLayer));
+}
+
+void render_layer_begin(RenderLayer* layer) {
+    SDL_SetRenderTarget(layer->renderer, layer->texture);
+    SDL_SetRenderDrawColor(layer->renderer, 0, 0, 0, layer->opaque ? 255 : 0);
+    SDL_RenderClear(layer->renderer);
+}
+
+void render_layer_end(RenderLayer* layer) {
+    SDL_SetRenderTarget(layer->renderer, NULL);
+    layer->valid = true;
+}
+
+void render_layer_draw(const RenderLayer* layer) {
+    SDL_RenderTexture(layer->renderer, layer->texture, NULL, &layer->rect);
+}
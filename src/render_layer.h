@@ -0,0 +1,30 @@
+#ifndef BRICKED_UP_RENDER_LAYER_H
+#define BRICKED_UP_RENDER_LAYER_H
+
+// A render-target texture caching part of the screen that rarely changes. The owner
+// redraws it between render_layer_begin and render_layer_end when whatever it shows has
+// changed, and otherwise just blits it each frame with render_layer_draw.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+typedef struct {
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+    SDL_FRect rect; // where the layer sits on screen
+    bool opaque;
+    bool valid; // false until drawn, and after the renderer loses its targets
+} RenderLayer;
+
+// An opaque layer replaces what's under it, a transparent one blends over it.
+bool render_layer_init(RenderLayer* layer, SDL_Renderer* renderer, SDL_FRect rect, bool opaque);
+void render_layer_destroy(RenderLayer* layer);
+
+// Points drawing at the layer, cleared, with the layer's top-left corner at (0, 0):
+// subtract rect.x and rect.y from screen coordinates while drawing into it.
+void render_layer_begin(RenderLayer* layer);
+void render_layer_end(RenderLayer* layer);
+
+void render_layer_draw(const RenderLayer* layer);
+
+#endif
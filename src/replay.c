@@ -0,0 +1,219 @@
+#include "replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define REPLAY_VERSION 5
+
+// Record kinds 0 to SIM_INPUT_COUNT - 1 are the inputs themselves
+#define REPLAY_RECORD_HASH 0x40
+#define REPLAY_RECORD_END 0x41
+
+struct Replay {
+    FILE* file;
+    bool recording;
+    Uint64 seed;
+    Uint64 levels_hash;
+    Uint32 flags;
+    Uint64 last_step; // step of the previous record, records store the delta
+    // Playback: the next record, read ahead so before_step knows when it is due
+    bool has_record;
+    Uint8 kind;
+    Uint64 step;
+    Uint64 hash;
+    bool finished;
+    bool diverged;
+    Uint64 divergence_step;
+};
+
+static void write_u32(FILE* file, Uint32 value) {
+    for (int i = 0; i < 4; i++) fputc((value >> (i * 8)) & 0xFF, file);
+}
+
+static void write_u64(FILE* file, Uint64 value) {
+    for (int i = 0; i < 8; i++) fputc((int)((value >> (i * 8)) & 0xFF), file);
+}
+
+static void write_varint(FILE* file, Uint64 value) {
+    while (value >= 0x80) {
+        fputc((int)(value & 0x7F) | 0x80, file);
+        value >>= 7;
+    }
+    fputc((int)value, file);
+}
+
+static bool read_u32(FILE* file, Uint32* value) {
+    *value = 0;
+    for (int i = 0; i < 4; i++) {
+        int c = fgetc(file);
+        if (c == EOF) return false;
+        *value |= (Uint32)c << (i * 8);
+    }
+    return true;
+}
+
+static bool read_u64(FILE* file, Uint64* value) {
+    *value = 0;
+    for (int i = 0; i < 8; i++) {
+        int c = fgetc(file);
+        if (c == EOF) return false;
+        *value |= (Uint64)c << (i * 8);
+    }
+    return true;
+}
+
+static bool read_varint(FILE* file, Uint64* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(file);
+        if (c == EOF) return false;
+        *value |= (Uint64)(c & 0x7F) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+static void write_record(Replay* replay, Uint8 kind, Uint64 step) {
+    fputc(kind, replay->file);
+    write_varint(replay->file, step - replay->last_step);
+    replay->last_step = step;
+}
+
+// A truncated file plays as if it ended there; everything up to the cut is still checked.
+static void read_record(Replay* replay) {
+    Uint64 delta;
+    int kind = fgetc(replay->file);
+
+    replay->has_record = false;
+    if (kind == EOF || !read_varint(replay->file, &delta)) return;
+    replay->kind = (Uint8)kind;
+    replay->step = replay->last_step + delta;
+    replay->last_step = replay->step;
+    if (kind == REPLAY_RECORD_HASH || kind == REPLAY_RECORD_END) {
+        if (!read_u64(replay->file, &replay->hash)) return;
+    } else if (kind >= SIM_INPUT_COUNT) {
+        printf("Replay: unknown record kind %d at step %llu\n", kind, (unsigned long long)replay->step);
+        return;
+    }
+    replay->has_record = true;
+}
+
+Replay* replay_create(const char* path, Uint64 seed, Uint64 levels_hash, Uint32 flags) {
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        printf("Failed to create replay: %s\n", path);
+        return NULL;
+    }
+
+    Replay* replay = calloc(1, sizeof(Replay));
+    replay->file = file;
+    replay->recording = true;
+    replay->seed = seed;
+    replay->levels_hash = levels_hash;
+    replay->flags = flags;
+    fwrite("BUPR", 1, 4, file);
+    write_u32(file, REPLAY_VERSION);
+    write_u64(file, seed);
+    write_u64(file, levels_hash);
+    write_u32(file, flags);
+    return replay;
+}
+
+Replay* replay_open(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        printf("Failed to open replay: %s\n", path);
+        return NULL;
+    }
+
+    char magic[4];
+    Uint32 version;
+    Uint64 seed;
+    Uint64 levels_hash = 0;
+    Uint32 flags = 0;
+    if (fread(magic, 1, 4, file) != 4 || magic[0] != 'B' || magic[1] != 'U' || magic[2] != 'P' || magic[3] != 'R' ||
+        !read_u32(file, &version) || !read_u64(file, &seed) ||
+        (version == REPLAY_VERSION && (!read_u64(file, &levels_hash) || !read_u32(file, &flags)))) {
+        printf("Not a replay file: %s\n", path);
+        fclose(file);
+        return NULL;
+    }
+    if (version != REPLAY_VERSION) {
+        printf("Unsupported replay version %u: %s\n", version, path);
+        fclose(file);
+        return NULL;
+    }
+
+    Replay* replay = calloc(1, sizeof(Replay));
+    replay->file = file;
+    replay->seed = seed;
+    replay->levels_hash = levels_hash;
+    replay->flags = flags;
+    read_record(replay);
+    return replay;
+}
+
+void replay_close(Replay* replay, const GameState* gs, Uint64 steps) {
+    if (replay == NULL) return;
+
+    if (replay->recording) {
+        write_record(replay, REPLAY_RECORD_END, steps);
+        write_u64(replay->file, sim_hash(gs));
+    }
+    fclose(replay->file);
+    free(replay);
+}
+
+Uint64 replay_seed(const Replay* replay) {
+    return replay->seed;
+}
+
+Uint64 replay_levels_hash(const Replay* replay) {
+    return replay->levels_hash;
+}
+
+Uint32 replay_flags(const Replay* replay) {
+    return replay->flags;
+}
+
+void replay_record_input(Replay* replay, Uint64 step, SimInput input) {
+    write_record(replay, (Uint8)input, step);
+}
+
+void replay_before_step(GameState* gs, Uint64 step, void* userdata) {
+    Replay* replay = userdata;
+
+    if (replay->recording) {
+        if (step % REPLAY_HASH_INTERVAL == 0) {
+            write_record(replay, REPLAY_RECORD_HASH, step);
+            write_u64(replay->file, sim_hash(gs));
+        }
+        return;
+    }
+
+    // Records are in step order and, within a step, in the order they happened
+    while (replay->has_record && replay->step <= step && !replay->finished) {
+        if (replay->kind == REPLAY_RECORD_HASH || replay->kind == REPLAY_RECORD_END) {
+            if (!replay->diverged && sim_hash(gs) != replay->hash) {
+                replay->diverged = true;
+                replay->divergence_step = step;
+            }
+            if (replay->kind == REPLAY_RECORD_END) replay->finished = true;
+        } else {
+            sim_apply_input(gs, (SimInput)replay->kind);
+        }
+        read_record(replay);
+    }
+    if (!replay->has_record) replay->finished = true;
+}
+
+bool replay_finished(const Replay* replay) {
+    return replay->finished;
+}
+
+bool replay_diverged(const Replay* replay) {
+    return replay->diverged;
+}
+
+Uint64 replay_divergence_step(const Replay* replay) {
+    return replay->divergence_step;
+}
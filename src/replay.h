@@ -0,0 +1,43 @@
+#ifndef BRICKED_UP_REPLAY_H
+#define BRICKED_UP_REPLAY_H
+
+// Input recording and playback. A replay is the seed of one game plus every SimInput
+// tagged with the fixed step it was applied before, and a sim_hash every
+// REPLAY_HASH_INTERVAL steps so playback can tell exactly where it diverged.
+//
+// File layout (little endian): "BUPR", u32 version, u64 seed, u64 content hash of the
+// level pack the game was played on (0 for the built-in board), u32 mode flags, then records of
+// u8 kind, varint step delta from the previous record, and for hash and end records
+// a u64 sim_hash of the state at that step.
+
+#include "sim.h"
+
+#define REPLAY_HASH_INTERVAL 30 // four checks per second of play
+#define REPLAY_FLAG_CHAOS 0x1 // the game was played in chaos mode
+
+typedef struct Replay Replay;
+
+// Both return NULL, with a message printed, if the file can't be used.
+Replay* replay_create(const char* path, Uint64 seed, Uint64 levels_hash, Uint32 flags);
+Replay* replay_open(const char* path);
+
+// Writes the end record when recording, then frees the replay.
+void replay_close(Replay* replay, const GameState* gs, Uint64 steps);
+
+Uint64 replay_seed(const Replay* replay);
+Uint64 replay_levels_hash(const Replay* replay);
+Uint32 replay_flags(const Replay* replay);
+
+// Recording: note an input applied before fixed step `step`.
+void replay_record_input(Replay* replay, Uint64 step, SimInput input);
+
+// SimStepFn for SimClock.before_step. Recording writes the periodic hash; playback
+// applies the inputs due at `step` and checks the state against the recorded hashes.
+void replay_before_step(GameState* gs, Uint64 step, void* userdata);
+
+// Playback: reached the end record, or found a state that doesn't match the recording.
+bool replay_finished(const Replay* replay);
+bool replay_diverged(const Replay* replay);
+Uint64 replay_divergence_step(const Replay* replay);
+
+#endif
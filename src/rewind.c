@@ -0,0 +1,416 @@
+#include "rewind.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// GameState fields outside the big arrays, gathered so they sit together at the front of
+// an image. Zeroed before filling, so padding never shows up as a change.
+typedef struct {
+    SDL_FRect paddle;
+    float prev_paddle_x;
+    BrickGrid brick_grid;
+    const LevelPack* levels;
+    int level;
+    int brick_count;
+    int live;
+    int animating_count;
+    int ball_count;
+    bool chaos;
+    bool ball_launched;
+    bool left_pressed;
+    bool right_pressed;
+    bool paused;
+    bool game_over;
+    int lives;
+    int paddle_size_level;
+    Uint64 last_powerup_spawn_time_ns;
+    Uint64 sticky_paddle_timer_ns;
+    float force_field_y_offset;
+    float force_field_anim_timer;
+    Uint64 sim_time_ns;
+    Uint64 rng_state;
+    GameStats stats;
+    float paddle_vel_x;
+} RewindScalars;
+
+typedef struct {
+    void* data;
+    size_t size;
+} ImageSection;
+
+#define IMAGE_SECTIONS 8
+#define REWIND_BLOCK_WORDS 32 // compared at once when looking for unchanged stretches
+
+typedef struct {
+    size_t offset; // in words, into data
+    size_t size; // words
+    size_t image_words;
+    Uint64 time_ns;
+    bool keyframe;
+} RewindFrame;
+
+struct RewindBuffer {
+    Uint64* data; // encoded frames, oldest first, wrapping around
+    size_t data_words;
+    size_t head; // where the next frame goes
+    size_t used_words;
+    RewindFrame* frames; // ring of max_frames
+    int max_frames;
+    int keyframe_interval;
+    int first;
+    int count;
+    int since_keyframe;
+    bool need_keyframe;
+    Uint64* reference; // image of the newest frame, zero past reference_words
+    size_t reference_words;
+    Uint64* encoded; // scratch for the frame being captured
+    Uint64* work; // scratch for the image being restored
+    size_t work_words; // past this, work is zero
+};
+
+static size_t words_for(size_t bytes) {
+    return (bytes + sizeof(Uint64) - 1) / sizeof(Uint64);
+}
+
+// Everything after the scalars, in image order. Balls go last: their count changes most
+// often, and a change in length only disturbs what follows it.
+static int image_sections(GameState* gs, int brick_count, int ball_count, ImageSection* sections) {
+    int n = 0;
+    size_t bitset_size = sizeof(Uint64) * BITSET_WORDS(brick_count);
+    sections[n++] = (ImageSection){ gs->powerups, sizeof(gs->powerups) };
+    sections[n++] = (ImageSection){ gs->bricks.alive, bitset_size };
+    sections[n++] = (ImageSection){ gs->bricks.collidable, bitset_size };
+    sections[n++] = (ImageSection){ gs->bricks.animating, bitset_size };
+    sections[n++] = (ImageSection){ gs->bricks.hits_left, brick_count };
+    sections[n++] = (ImageSection){ gs->bricks.animation_frame, sizeof(int) * brick_count };
+    sections[n++] = (ImageSection){ gs->bricks.animation_timer, sizeof(float) * brick_count };
+    sections[n++] = (ImageSection){ gs->balls, sizeof(Ball) * ball_count };
+    return n;
+}
+
+// The largest image image_sections can describe
+static size_t max_image_words(void) {
+    return words_for(sizeof(RewindScalars)) + words_for(sizeof(PowerUp) * MAX_POWERUPS) +
+        3 * BITSET_WORDS(MAX_BRICKS) + words_for(MAX_BRICKS) + words_for(sizeof(int) * MAX_BRICKS) +
+        words_for(sizeof(float) * MAX_BRICKS) + words_for(sizeof(Ball) * MAX_BALLS);
+}
+
+static void pack_scalars(RewindScalars* scalars, const GameState* gs) {
+    memset(scalars, 0, sizeof(*scalars));
+    scalars->paddle = gs->paddle;
+    scalars->prev_paddle_x = gs->prev_paddle_x;
+    scalars->brick_grid = gs->brick_grid;
+    scalars->levels = gs->levels;
+    scalars->level = gs->level;
+    scalars->brick_count = gs->bricks.count;
+    scalars->live = gs->bricks.live;
+    scalars->animating_count = gs->bricks.animating_count;
+    scalars->ball_count = gs->ball_count;
+    scalars->chaos = gs->chaos;
+    scalars->ball_launched = gs->ball_launched;
+    scalars->left_pressed = gs->left_pressed;
+    scalars->right_pressed = gs->right_pressed;
+    scalars->paused = gs->paused;
+    scalars->game_over = gs->game_over;
+    scalars->lives = gs->lives;
+    scalars->paddle_size_level = gs->paddle_size_level;
+    scalars->last_powerup_spawn_time_ns = gs->last_powerup_spawn_time_ns;
+    scalars->sticky_paddle_timer_ns = gs->sticky_paddle_timer_ns;
+    scalars->force_field_y_offset = gs->force_field_y_offset;
+    scalars->force_field_anim_timer = gs->force_field_anim_timer;
+    scalars->sim_time_ns = gs->sim_time_ns;
+    scalars->rng_state = gs->rng_state;
+    scalars->stats = gs->stats;
+    scalars->paddle_vel_x = gs->paddle_vel_x;
+}
+
+static void unpack_scalars(GameState* gs, const RewindScalars* scalars) {
+    gs->paddle = scalars->paddle;
+    gs->prev_paddle_x = scalars->prev_paddle_x;
+    gs->brick_grid = scalars->brick_grid;
+    gs->levels = scalars->levels;
+    gs->level = scalars->level;
+    gs->bricks.count = scalars->brick_count;
+    gs->bricks.live = scalars->live;
+    gs->bricks.animating_count = scalars->animating_count;
+    gs->ball_count = scalars->ball_count;
+    gs->chaos = scalars->chaos;
+    gs->ball_launched = scalars->ball_launched;
+    gs->left_pressed = scalars->left_pressed;
+    gs->right_pressed = scalars->right_pressed;
+    gs->paused = scalars->paused;
+    gs->game_over = scalars->game_over;
+    gs->lives = scalars->lives;
+    gs->paddle_size_level = scalars->paddle_size_level;
+    gs->last_powerup_spawn_time_ns = scalars->last_powerup_spawn_time_ns;
+    gs->sticky_paddle_timer_ns = scalars->sticky_paddle_timer_ns;
+    gs->force_field_y_offset = scalars->force_field_y_offset;
+    gs->force_field_anim_timer = scalars->force_field_anim_timer;
+    gs->sim_time_ns = scalars->sim_time_ns;
+    gs->rng_state = scalars->rng_state;
+    gs->stats = scalars->stats;
+    gs->paddle_vel_x = scalars->paddle_vel_x;
+}
+
+// Encoded frames are runs: a header word holding the count of unchanged words (high half)
+// and of changed words (low half), then the changed words XORed with the old ones. Unchanged
+// words at the end have no run. A keyframe is the same thing against an all-zero image.
+typedef struct {
+    Uint64* reference; // the previous image, overwritten with this one as it goes
+    Uint64* out;
+    size_t pos; // image words so far
+    size_t out_words;
+    size_t header; // where the open run's header goes
+    Uint32 unchanged;
+    Uint32 changed;
+    bool keyframe;
+} Encoder;
+
+static void close_run(Encoder* e) {
+    e->out[e->header] = (Uint64)e->unchanged << 32 | e->changed;
+    e->unchanged = 0;
+    e->changed = 0;
+}
+
+static inline void encode_word(Encoder* e, Uint64 word) {
+    Uint64 delta = e->keyframe ? word : word ^ e->reference[e->pos];
+    e->reference[e->pos++] = word;
+    if (delta == 0) {
+        if (e->changed > 0) close_run(e);
+        e->unchanged++;
+    } else {
+        if (e->changed == 0) e->header = e->out_words++;
+        e->out[e->out_words++] = delta;
+        e->changed++;
+    }
+}
+
+static void encode_section(Encoder* e, const void* data, size_t size) {
+    const Uint8* bytes = data;
+    size_t whole = size / sizeof(Uint64);
+    for (size_t i = 0; i < whole;) {
+        // Most of a delta is unchanged; skip it a block at a time
+        if (!e->keyframe && whole - i >= REWIND_BLOCK_WORDS &&
+            memcmp(bytes + i * sizeof(Uint64), &e->reference[e->pos], REWIND_BLOCK_WORDS * sizeof(Uint64)) == 0) {
+            if (e->changed > 0) close_run(e);
+            e->unchanged += REWIND_BLOCK_WORDS;
+            e->pos += REWIND_BLOCK_WORDS;
+            i += REWIND_BLOCK_WORDS;
+            continue;
+        }
+        size_t end = SDL_min(whole, i + REWIND_BLOCK_WORDS);
+        for (; i < end; i++) {
+            Uint64 word;
+            memcpy(&word, bytes + i * sizeof(Uint64), sizeof(word));
+            encode_word(e, word);
+        }
+    }
+    if (size % sizeof(Uint64) != 0) {
+        Uint64 word = 0;
+        memcpy(&word, bytes + whole * sizeof(Uint64), size % sizeof(Uint64));
+        encode_word(e, word);
+    }
+}
+
+// Encodes the image into rewind->encoded and makes it the new reference. Returns its size in words.
+static size_t encode_image(RewindBuffer* rewind, const RewindScalars* scalars, const ImageSection* sections, int count, bool keyframe, size_t* image_words) {
+    Encoder e = { .reference = rewind->reference, .out = rewind->encoded, .keyframe = keyframe };
+    encode_section(&e, scalars, sizeof(*scalars));
+    for (int i = 0; i < count; i++) {
+        encode_section(&e, sections[i].data, sections[i].size);
+    }
+    *image_words = e.pos;
+    // Words past the end of a shorter image count as zero
+    while (e.pos < rewind->reference_words) {
+        encode_word(&e, 0);
+    }
+    if (e.changed > 0) close_run(&e);
+    rewind->reference_words = *image_words;
+    return e.out_words;
+}
+
+static void decode_frame(Uint64* image, const Uint64* in, size_t size) {
+    size_t pos = 0;
+    for (size_t i = 0; i < size;) {
+        Uint64 header = in[i++];
+        pos += header >> 32;
+        for (Uint32 changed = (Uint32)header; changed > 0; changed--) {
+            image[pos++] ^= in[i++];
+        }
+    }
+}
+
+static RewindFrame* frame_at(const RewindBuffer* rewind, int frame) {
+    return &rewind->frames[(rewind->first + frame) % rewind->max_frames];
+}
+
+static void drop_oldest(RewindBuffer* rewind) {
+    rewind->used_words -= frame_at(rewind, 0)->size;
+    rewind->first = (rewind->first + 1) % rewind->max_frames;
+    rewind->count--;
+    if (rewind->count == 0) rewind->head = 0;
+}
+
+// Frees `size` contiguous words at head, dropping the oldest frames in the way, and any
+// deltas whose keyframe went with them.
+static bool make_room(RewindBuffer* rewind, size_t size) {
+    if (size > rewind->data_words) return false;
+    if (rewind->count == rewind->max_frames) drop_oldest(rewind);
+    if (rewind->head + size > rewind->data_words) {
+        // Frames at or past the old head are left from the last lap and older than any at 0.
+        // They all go now: the loop below only looks at the oldest frame, and would stop at a
+        // keyframe among them while this lap's frames at 0 were written over.
+        size_t old_head = rewind->head;
+        rewind->head = 0;
+        while (rewind->count > 0 && frame_at(rewind, 0)->offset >= old_head) {
+            drop_oldest(rewind);
+        }
+    }
+    while (rewind->count > 0) {
+        const RewindFrame* oldest = frame_at(rewind, 0);
+        bool in_the_way = oldest->offset < rewind->head + size && rewind->head < oldest->offset + oldest->size;
+        if (!in_the_way && oldest->keyframe) break;
+        drop_oldest(rewind);
+    }
+    return true;
+}
+
+RewindBuffer* rewind_create(size_t bytes, int max_frames, int keyframe_interval) {
+    RewindBuffer* rewind = calloc(1, sizeof(RewindBuffer));
+    if (rewind == NULL) return NULL;
+    size_t image_words = max_image_words();
+    rewind->data_words = bytes / sizeof(Uint64);
+    rewind->max_frames = max_frames;
+    rewind->keyframe_interval = keyframe_interval;
+    rewind->data = malloc(sizeof(Uint64) * rewind->data_words);
+    rewind->frames = malloc(sizeof(RewindFrame) * max_frames);
+    rewind->reference = calloc(image_words, sizeof(Uint64));
+    rewind->work = calloc(image_words, sizeof(Uint64));
+    // A run header per changed word at most, and one more at the start
+    rewind->encoded = malloc(sizeof(Uint64) * (image_words + 1));
+    if (rewind->data == NULL || rewind->frames == NULL || rewind->reference == NULL || rewind->work == NULL || rewind->encoded == NULL) {
+        printf("Failed to allocate %zu bytes for the rewind buffer\n", bytes);
+        rewind_destroy(rewind);
+        return NULL;
+    }
+    return rewind;
+}
+
+void rewind_destroy(RewindBuffer* rewind) {
+    if (rewind == NULL) return;
+    free(rewind->encoded);
+    free(rewind->work);
+    free(rewind->reference);
+    free(rewind->frames);
+    free(rewind->data);
+    free(rewind);
+}
+
+void rewind_clear(RewindBuffer* rewind) {
+    rewind->first = 0;
+    rewind->count = 0;
+    rewind->head = 0;
+    rewind->used_words = 0;
+    rewind->need_keyframe = true;
+}
+
+bool rewind_capture(RewindBuffer* rewind, const GameState* gs) {
+    RewindScalars scalars;
+    ImageSection sections[IMAGE_SECTIONS];
+    pack_scalars(&scalars, gs);
+    // Only read from; the same list tells rewind_restore where to write
+    int count = image_sections((GameState*)gs, gs->bricks.count, gs->ball_count, sections);
+
+    bool keyframe = rewind->count == 0 || rewind->need_keyframe || rewind->since_keyframe >= rewind->keyframe_interval;
+    size_t image_words;
+    size_t size = encode_image(rewind, &scalars, sections, count, keyframe, &image_words);
+    if (!make_room(rewind, size)) {
+        rewind_clear(rewind);
+        return false;
+    }
+    if (rewind->count == 0 && !keyframe) {
+        // Room was made by dropping this delta's keyframe
+        keyframe = true;
+        size = encode_image(rewind, &scalars, sections, count, keyframe, &image_words);
+        if (!make_room(rewind, size)) {
+            rewind_clear(rewind);
+            return false;
+        }
+    }
+
+    RewindFrame* frame = frame_at(rewind, rewind->count++);
+    frame->offset = rewind->head;
+    frame->size = size;
+    frame->image_words = image_words;
+    frame->time_ns = gs->sim_time_ns;
+    frame->keyframe = keyframe;
+    memcpy(rewind->data + rewind->head, rewind->encoded, sizeof(Uint64) * size);
+    rewind->head += size;
+    rewind->used_words += size;
+    rewind->since_keyframe = keyframe ? 1 : rewind->since_keyframe + 1;
+    rewind->need_keyframe = false;
+    return true;
+}
+
+int rewind_count(const RewindBuffer* rewind) {
+    return rewind->count;
+}
+
+Uint64 rewind_frame_time_ns(const RewindBuffer* rewind, int frame) {
+    return frame_at(rewind, frame)->time_ns;
+}
+
+size_t rewind_bytes_used(const RewindBuffer* rewind) {
+    return sizeof(Uint64) * rewind->used_words;
+}
+
+bool rewind_restore(RewindBuffer* rewind, int frame, GameState* gs) {
+    if (frame < 0 || frame >= rewind->count) return false;
+
+    // Rebuild the image from the chain's keyframe
+    int key = frame;
+    while (!frame_at(rewind, key)->keyframe) key--;
+    memset(rewind->work, 0, sizeof(Uint64) * rewind->work_words);
+    rewind->work_words = 0;
+    for (int i = key; i <= frame; i++) {
+        const RewindFrame* f = frame_at(rewind, i);
+        decode_frame(rewind->work, rewind->data + f->offset, f->size);
+        rewind->work_words = SDL_max(rewind->work_words, f->image_words);
+    }
+
+    const RewindScalars* scalars = (const RewindScalars*)rewind->work;
+    if (gs->bricks.layout_id == 0 || gs->levels != scalars->levels || gs->level != scalars->level ||
+        gs->bricks.count != scalars->brick_count) {
+        gs->levels = scalars->levels;
+        gs->level = scalars->level;
+        lay_out_board(gs);
+    } else {
+        // Same board, but bricks may come back from the dead
+        gs->bricks.layout_id = new_layout_id();
+    }
+    unpack_scalars(gs, scalars);
+
+    ImageSection sections[IMAGE_SECTIONS];
+    int count = image_sections(gs, scalars->brick_count, scalars->ball_count, sections);
+    const Uint64* from = rewind->work + words_for(sizeof(RewindScalars));
+    for (int i = 0; i < count; i++) {
+        memcpy(sections[i].data, from, sections[i].size);
+        from += words_for(sections[i].size);
+    }
+    return true;
+}
+
+void rewind_truncate(RewindBuffer* rewind, int count) {
+    if (count >= rewind->count) return;
+    while (rewind->count > count) {
+        rewind->used_words -= frame_at(rewind, --rewind->count)->size;
+    }
+    if (rewind->count == 0) {
+        rewind->head = 0;
+    } else {
+        const RewindFrame* newest = frame_at(rewind, rewind->count - 1);
+        rewind->head = newest->offset + newest->size;
+    }
+    // The reference image is of a frame that's gone
+    rewind->need_keyframe = true;
+}
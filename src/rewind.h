@@ -0,0 +1,43 @@
+#ifndef BRICKED_UP_REWIND_H
+#define BRICKED_UP_REWIND_H
+
+// A fixed-size history of recent game states, for rewinding and for stepping back while
+// debugging. Each frame is a flat image of everything in GameState that decides how the
+// game goes on (bricks, balls, power-ups, paddle, timers, the generator), stored as the XOR
+// against the frame before it, with runs of unchanged words left out. Every keyframe
+// interval a full image starts a new chain. When the buffer fills, the oldest chain goes.
+// All memory is allocated up front, so capturing and restoring never allocate and cost
+// about as much as the state that changed.
+//
+// Brick geometry isn't stored: a restore lays the board out again from the level pack when
+// it differs. Particles and game_speed are left alone.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include "sim.h"
+
+#define REWIND_KEYFRAME_INTERVAL 60 // frames; a restore decodes up to this many
+
+typedef struct RewindBuffer RewindBuffer;
+
+// Keeps up to `max_frames` frames in `bytes` of storage, whichever runs out first, with
+// a keyframe every `keyframe_interval` frames. Dropping the oldest frame drops its whole
+// chain, so at least max_frames - keyframe_interval frames stay once it's full.
+RewindBuffer* rewind_create(size_t bytes, int max_frames, int keyframe_interval);
+void rewind_destroy(RewindBuffer* rewind);
+void rewind_clear(RewindBuffer* rewind);
+
+// Adds `gs` as the newest frame. False, with the buffer emptied, if one frame doesn't fit.
+bool rewind_capture(RewindBuffer* rewind, const GameState* gs);
+
+// Frames are numbered from 0, the oldest still held, to rewind_count - 1, the newest.
+int rewind_count(const RewindBuffer* rewind);
+Uint64 rewind_frame_time_ns(const RewindBuffer* rewind, int frame); // the frame's sim_time_ns
+size_t rewind_bytes_used(const RewindBuffer* rewind);
+
+// Puts `gs` back the way it was at `frame`. The frames are kept, so a later restore can go
+// either way; rewind_truncate drops the ones after it before play continues.
+bool rewind_restore(RewindBuffer* rewind, int frame, GameState* gs);
+void rewind_truncate(RewindBuffer* rewind, int count);
+
+#endif
@@ -0,0 +1,1248 @@
+#include "sim.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BRICK_BATCH_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BRICK_BATCH_WIDTH 4
+#else
+#define BRICK_BATCH_WIDTH 1
+#endif
+
+void sim_seed(GameState* gs, Uint64 seed) {
+    gs->rng_state = seed;
+}
+
+// SplitMix64: one add and three mixes per draw, and any seed (including 0) is fine.
+Uint32 sim_rand(GameState* gs) {
+    Uint64 z = (gs->rng_state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return (Uint32)((z ^ (z >> 31)) >> 32);
+}
+
+// Uniform in [0, 1)
+float sim_randf(GameState* gs) {
+    return (sim_rand(gs) >> 8) * (1.0f / 16777216.0f);
+}
+
+// A fresh game that depends on nothing but `seed` and the boards in `levels` (NULL for the
+// built-in board).
+void sim_start_game(GameState* gs, Uint64 seed, const LevelPack* levels) {
+    memset(gs, 0, sizeof(GameState));
+    gs->levels = levels != NULL ? levels : level_pack_builtin();
+    sim_seed(gs, seed);
+    reset_game(gs);
+}
+
+void sim_apply_input(GameState* gs, SimInput input) {
+    switch (input) {
+        case SIM_INPUT_LEFT_DOWN:
+            gs->left_pressed = true;
+            break;
+        case SIM_INPUT_LEFT_UP:
+            gs->left_pressed = false;
+            break;
+        case SIM_INPUT_RIGHT_DOWN:
+            gs->right_pressed = true;
+            break;
+        case SIM_INPUT_RIGHT_UP:
+            gs->right_pressed = false;
+            break;
+        case SIM_INPUT_LAUNCH:
+            launch_pressed(gs);
+            break;
+        case SIM_INPUT_PAUSE:
+            gs->paused = !gs->paused;
+            break;
+        default:
+            break;
+    }
+}
+
+// FNV-1a, fed field by field so struct padding never reaches the hash
+static Uint64 hash_bytes(Uint64 hash, const void* data, size_t size) {
+    const Uint8* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+#define HASH_FIELD(hash, field) hash_bytes(hash, &(field), sizeof(field))
+
+// Debris colour for each brick colour in the spritesheet
+static const SDL_Color debris_colors[BRICK_SPRITE_ROWS] = {
+    {230, 80, 80, 255},
+    {240, 150, 60, 255},
+    {240, 220, 80, 255},
+    {110, 210, 90, 255},
+    {80, 170, 240, 255},
+    {170, 110, 230, 255},
+};
+
+const SDL_FRect sim_walls[SIM_WALL_COUNT] = {
+    {0, TOP_MARGIN - 10, SCREEN_WIDTH, 10}, // Top
+    {BORDER_THICKNESS - 10, 0, 10, SCREEN_HEIGHT}, // Left
+    {SCREEN_WIDTH - BORDER_THICKNESS, 0, 10, SCREEN_HEIGHT} // Right
+};
+
+// Hash of everything that decides how the game plays out from here. Render-only state
+// (interpolation positions) and game_speed, which only maps wall time to steps, are left out.
+Uint64 sim_hash(const GameState* gs) {
+    Uint64 hash = 0xCBF29CE484222325ull;
+
+    int count = gs->bricks.count;
+    hash = HASH_FIELD(hash, gs->paddle);
+    hash = HASH_FIELD(hash, gs->level);
+    hash = HASH_FIELD(hash, gs->bricks.count);
+    hash = hash_bytes(hash, gs->bricks.x, sizeof(float) * count);
+    hash = hash_bytes(hash, gs->bricks.y, sizeof(float) * count);
+    hash = hash_bytes(hash, gs->bricks.w, sizeof(float) * count);
+    hash = hash_bytes(hash, gs->bricks.h, sizeof(float) * count);
+    hash = HASH_FIELD(hash, gs->bricks.live);
+    hash = hash_bytes(hash, gs->bricks.alive, sizeof(Uint64) * BITSET_WORDS(count));
+    hash = hash_bytes(hash, gs->bricks.collidable, sizeof(Uint64) * BITSET_WORDS(count));
+    hash = hash_bytes(hash, gs->bricks.animation_frame, sizeof(int) * count);
+    hash = hash_bytes(hash, gs->bricks.animation_timer, sizeof(float) * count);
+    hash = hash_bytes(hash, gs->bricks.hits_left, count);
+    for (int i = 0; i < MAX_POWERUPS; i++) {
+        const PowerUp* powerup = &gs->powerups[i];
+        hash = HASH_FIELD(hash, powerup->active);
+        if (!powerup->active) continue;
+        hash = HASH_FIELD(hash, powerup->rect);
+        hash = HASH_FIELD(hash, powerup->type);
+    }
+    hash = HASH_FIELD(hash, gs->ball_count);
+    hash = HASH_FIELD(hash, gs->chaos);
+    for (int i = 0; i < gs->ball_count; i++) {
+        const Ball* ball = &gs->balls[i];
+        hash = HASH_FIELD(hash, ball->rect);
+        hash = HASH_FIELD(hash, ball->vel_x);
+        hash = HASH_FIELD(hash, ball->vel_y);
+        hash = HASH_FIELD(hash, ball->last_collision_time_ns);
+        hash = HASH_FIELD(hash, ball->is_stuck);
+        hash = HASH_FIELD(hash, ball->stuck_offset_x);
+    }
+    hash = HASH_FIELD(hash, gs->ball_launched);
+    hash = HASH_FIELD(hash, gs->left_pressed);
+    hash = HASH_FIELD(hash, gs->right_pressed);
+    hash = HASH_FIELD(hash, gs->lives);
+    hash = HASH_FIELD(hash, gs->paddle_size_level);
+    hash = HASH_FIELD(hash, gs->last_powerup_spawn_time_ns);
+    hash = HASH_FIELD(hash, gs->sticky_paddle_timer_ns);
+    hash = HASH_FIELD(hash, gs->force_field_y_offset);
+    hash = HASH_FIELD(hash, gs->force_field_anim_timer);
+    hash = HASH_FIELD(hash, gs->paused);
+    hash = HASH_FIELD(hash, gs->game_over);
+    hash = HASH_FIELD(hash, gs->sim_time_ns);
+    hash = HASH_FIELD(hash, gs->rng_state);
+    hash = HASH_FIELD(hash, gs->paddle_vel_x);
+    return hash;
+}
+
+SDL_FRect brick_rect(const BrickField* field, int index) {
+    SDL_FRect rect = { field->x[index], field->y[index], field->w[index], field->h[index] };
+    return rect;
+}
+
+// Takes a brick off the board at once, without the breaking animation
+void brick_remove(BrickField* field, int index) {
+    if (!bitset_test(field->alive, index)) return;
+    if (bitset_test(field->animating, index)) field->animating_count--;
+    bitset_clear(field->alive, index);
+    bitset_clear(field->collidable, index);
+    bitset_clear(field->animating, index);
+    field->live--;
+}
+
+void launch_ball(Ball* ball, float paddle_x, float paddle_w) {
+    ball->is_stuck = false;
+    float ball_center_x = ball->rect.x + ball->rect.w / 2.0f;
+    float paddle_center_x = paddle_x + paddle_w / 2.0f;
+    
+    float diff = (ball_center_x - paddle_center_x) / (paddle_w / 2.0f);
+    
+    float angle = diff * (M_PI / 4.0f); // Max angle 45 degrees
+    
+    ball->vel_x = BALL_SPEED * sinf(angle);
+    ball->vel_y = -BALL_SPEED * cosf(angle);
+}
+
+// A new ball at the end of the pool, uninitialized, or NULL if no more are allowed in play
+static Ball* add_ball(GameState* gs) {
+    int limit = gs->chaos ? MAX_BALLS : BALL_LIMIT;
+    if (gs->ball_count >= limit) return NULL;
+    return &gs->balls[gs->ball_count++];
+}
+
+// Chaos mode serves a fan of balls spread evenly over 120 degrees
+static void fan_out_serve(GameState* gs) {
+    for (int i = 1; i < CHAOS_SERVE_BALLS; i++) {
+        Ball* ball = add_ball(gs);
+        if (ball == NULL) break;
+        float angle = ((float)i / (CHAOS_SERVE_BALLS - 1) - 0.5f) * (float)(2.0 * M_PI / 3.0);
+        *ball = gs->balls[0];
+        ball->vel_x = BALL_SPEED * sinf(angle);
+        ball->vel_y = -BALL_SPEED * cosf(angle);
+    }
+}
+
+// Space bar: launches the serve ball, or releases balls held by the sticky paddle.
+void launch_pressed(GameState* gs) {
+    if (gs->paused) return;
+
+    if (!gs->ball_launched) {
+        gs->ball_launched = true;
+        launch_ball(&gs->balls[0], gs->paddle.x, gs->paddle.w);
+        if (gs->chaos) fan_out_serve(gs);
+    } else {
+        for (int i = 0; i < gs->ball_count; i++) {
+            if (gs->balls[i].is_stuck) {
+                launch_ball(&gs->balls[i], gs->paddle.x, gs->paddle.w);
+            }
+        }
+    }
+}
+
+void initialize_powerups(GameState* gs) {
+    for (int i = 0; i < MAX_POWERUPS; i++) {
+        gs->powerups[i].active = false;
+    }
+}
+
+void spawn_powerup(GameState* gs, float x, float y) {
+    Uint64 current_time = gs->sim_time_ns;
+    if (current_time - gs->last_powerup_spawn_time_ns < SDL_MS_TO_NS(POWERUP_SPAWN_COOLDOWN)) {
+        return;
+    }
+
+    int rand_val = sim_rand(gs) % 100;
+    PowerUpType type;
+
+    if (rand_val < 5) {
+        type = POWERUP_BALL_SPLIT;
+    } else if (rand_val < 10) {
+        type = POWERUP_STICKY_PADDLE;
+    } else if (rand_val < 20) {
+        type = POWERUP_ADD_LIFE;
+    } else if (rand_val < 35) {
+        type = POWERUP_PADDLE_WIDER;
+    } else if (rand_val < 50) {
+        type = POWERUP_REMOVE_LIFE;
+    } else if (rand_val < 75) {
+        type = POWERUP_PADDLE_NARROWER;
+    } else {
+        return;
+    }
+
+    for (int i = 0; i < MAX_POWERUPS; i++) {
+        if (!gs->powerups[i].active) {
+            gs->powerups[i].active = true;
+            gs->powerups[i].rect.x = x;
+            gs->powerups[i].rect.y = y;
+            gs->powerups[i].prev_y = y;
+            gs->powerups[i].rect.w = POWERUP_SIZE;
+            gs->powerups[i].rect.h = POWERUP_SIZE;
+            gs->powerups[i].type = type;
+            gs->last_powerup_spawn_time_ns = current_time;
+            break;
+        }
+    }
+}
+
+void reset_ball(GameState* gs) {
+    gs->ball_launched = false;
+    gs->ball_count = 1;
+    gs->balls[0].active = true;
+    gs->balls[0].is_stuck = false;
+    gs->balls[0].vel_x = 0;
+    gs->balls[0].vel_y = 0;
+    gs->balls[0].rect.w = BALL_SIZE;
+    gs->balls[0].rect.h = BALL_SIZE;
+    gs->balls[0].rect.x = gs->paddle.x + (gs->paddle.w / 2) - (BALL_SIZE / 2);
+    gs->balls[0].rect.y = gs->paddle.y - BALL_SIZE;
+    gs->balls[0].last_collision_time_ns = 0;
+    gs->balls[0].prev_pos.x = gs->balls[0].rect.x;
+    gs->balls[0].prev_pos.y = gs->balls[0].rect.y;
+    initialize_powerups(gs);
+}
+
+static SDL_AtomicInt next_layout_id; // shared by every game, since games run on several threads
+
+int new_layout_id(void) {
+    return SDL_AddAtomicInt(&next_layout_id, 1) + 1;
+}
+
+void reset_game(GameState* gs) {
+    gs->lives = 3;
+    gs->paddle_size_level = 0;
+    gs->paddle.w = PADDLE_WIDTH_INITIAL;
+    gs->paddle.x = (SCREEN_WIDTH - gs->paddle.w) / 2;
+    gs->paddle.y = SCREEN_HEIGHT - PADDLE_HEIGHT - 10;
+    gs->paddle.h = PADDLE_HEIGHT;
+    gs->prev_paddle_x = gs->paddle.x;
+    gs->sticky_paddle_timer_ns = 0;
+    gs->force_field_y_offset = 0;
+    gs->force_field_anim_timer = 0;
+    if (gs->particles != NULL) particles_clear(gs->particles);
+    gs->paused = false;
+    gs->game_over = false;
+    gs->left_pressed = false;
+    gs->right_pressed = false;
+    gs->game_speed = 1.0f;
+    gs->paddle_vel_x = 0.0f;
+    gs->stats.board_start_ns = gs->sim_time_ns;
+    lay_out_board(gs);
+
+    // Start paging in the next board while this one is played
+    level_pack_prefetch(gs->levels, gs->level + 1);
+
+    reset_ball(gs);
+}
+
+// The grid and every brick of board gs->level, as it is before its first hit
+void lay_out_board(GameState* gs) {
+    const Level* level = level_pack_level(gs->levels, gs->level);
+    BrickGrid* grid = &gs->brick_grid;
+    int count = level->rows * level->cols;
+
+    // Boards bigger than the play area shrink uniformly, spacing included
+    float scale = 1.0f;
+    scale = SDL_min(scale, (float)(BOARD_WIDTH + BRICK_SPACING) / (level->cols * (BRICK_WIDTH + BRICK_SPACING)));
+    scale = SDL_min(scale, (float)(BOARD_HEIGHT + BRICK_SPACING) / (level->rows * (BRICK_HEIGHT + BRICK_SPACING)));
+    grid->rows = level->rows;
+    grid->cols = level->cols;
+    grid->brick_w = BRICK_WIDTH * scale;
+    grid->brick_h = BRICK_HEIGHT * scale;
+    grid->cell_w = (BRICK_WIDTH + BRICK_SPACING) * scale;
+    grid->cell_h = (BRICK_HEIGHT + BRICK_SPACING) * scale;
+    grid->origin_x = (SCREEN_WIDTH - (level->cols * grid->cell_w - BRICK_SPACING * scale)) / 2.0f;
+    grid->origin_y = 35 + TOP_MARGIN;
+
+    memset(gs->bricks.alive, 0, sizeof(gs->bricks.alive));
+    memset(gs->bricks.collidable, 0, sizeof(gs->bricks.collidable));
+    memset(gs->bricks.animating, 0, sizeof(gs->bricks.animating));
+    gs->bricks.animating_count = 0;
+    for (int i = 0; i < level->rows; i++) {
+        for (int j = 0; j < level->cols; j++) {
+            int index = i * level->cols + j;
+            int cell = level->cells[index];
+            bool filled = cell > 0 && cell <= level->type_count;
+            if (filled) {
+                bitset_set(gs->bricks.alive, index);
+                bitset_set(gs->bricks.collidable, index);
+            }
+            gs->bricks.animation_frame[index] = 0;
+            gs->bricks.animation_timer[index] = 0;
+            gs->bricks.sprite_row[index] = filled ? level->types[cell - 1].sprite_row : 0;
+            gs->bricks.hits_left[index] = filled ? level->types[cell - 1].hits : 0;
+            gs->bricks.w[index] = grid->brick_w;
+            gs->bricks.h[index] = grid->brick_h;
+            gs->bricks.x[index] = grid->origin_x + j * grid->cell_w;
+            gs->bricks.y[index] = grid->origin_y + i * grid->cell_h;
+        }
+    }
+    gs->bricks.count = count;
+    gs->bricks.layout_id = new_layout_id();
+    gs->bricks.live = 0;
+    for (int w = 0; w < BITSET_WORDS(count); w++) {
+        gs->bricks.live += bitset_popcount(gs->bricks.alive[w]);
+    }
+    // Padding lanes are only ever read by partial batches; keep them as finite empty boxes
+    for (int i = count; i < count + BRICK_FIELD_PADDING; i++) {
+        gs->bricks.x[i] = 0;
+        gs->bricks.y[i] = 0;
+        gs->bricks.w[i] = 0;
+        gs->bricks.h[i] = 0;
+    }
+}
+
+float swept_aabb(SDL_FRect b1, SDL_FPoint vel, SDL_FRect b2, float* normal_x, float* normal_y) {
+    float inv_entry_x, inv_entry_y;
+    float inv_exit_x, inv_exit_y;
+
+    if (vel.x > 0.0f) {
+        inv_entry_x = b2.x - (b1.x + b1.w);
+        inv_exit_x = (b2.x + b2.w) - b1.x;
+    } else {
+        inv_entry_x = (b2.x + b2.w) - b1.x;
+        inv_exit_x = b2.x - (b1.x + b1.w);
+    }
+
+    if (vel.y > 0.0f) {
+        inv_entry_y = b2.y - (b1.y + b1.h);
+        inv_exit_y = (b2.y + b2.h) - b1.y;
+    } else {
+        inv_entry_y = (b2.y + b2.h) - b1.y;
+        inv_exit_y = b2.y - (b1.y + b1.h);
+    }
+
+    float entry_x, entry_y;
+    float exit_x, exit_y;
+
+    if (vel.x == 0.0f) {
+        if (b1.x + b1.w < b2.x || b1.x > b2.x + b2.w) {
+            *normal_x = 0.0f;
+            *normal_y = 0.0f;
+            return 1.0f;
+        }
+        entry_x = -INFINITY;
+        exit_x = INFINITY;
+    } else {
+        entry_x = inv_entry_x / vel.x;
+        exit_x = inv_exit_x / vel.x;
+    }
+
+    if (vel.y == 0.0f) {
+        if (b1.y + b1.h < b2.y || b1.y > b2.y + b2.h) {
+            *normal_x = 0.0f;
+            *normal_y = 0.0f;
+            return 1.0f;
+        }
+        entry_y = -INFINITY;
+        exit_y = INFINITY;
+    } else {
+        entry_y = inv_entry_y / vel.y;
+        exit_y = inv_exit_y / vel.y;
+    }
+
+    float entry_time = fmaxf(entry_x, entry_y);
+    float exit_time = fminf(exit_x, exit_y);
+
+    if (entry_time > exit_time || entry_x < 0.0f && entry_y < 0.0f || entry_x > 1.0f || entry_y > 1.0f) {
+        *normal_x = 0.0f;
+        *normal_y = 0.0f;
+        return 1.0f;
+    }
+
+    if (entry_x > entry_y) {
+        *normal_x = (vel.x > 0.0f) ? -1.0f : 1.0f;
+        *normal_y = 0.0f;
+    } else {
+        *normal_x = 0.0f;
+        *normal_y = (vel.y > 0.0f) ? -1.0f : 1.0f;
+    }
+
+    return entry_time;
+}
+
+#if BRICK_BATCH_WIDTH == 8
+typedef __m256 BatchFloat;
+#define batch_load _mm256_loadu_ps
+#define batch_store _mm256_storeu_ps
+#define batch_set1 _mm256_set1_ps
+#define batch_add _mm256_add_ps
+#define batch_sub _mm256_sub_ps
+#define batch_div _mm256_div_ps
+#define batch_min _mm256_min_ps
+#define batch_max _mm256_max_ps
+#define batch_and _mm256_and_ps
+#define batch_or _mm256_or_ps
+#define batch_lt(a, b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define batch_gt(a, b) _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#define batch_select(mask, a, b) _mm256_blendv_ps(b, a, mask)
+#elif BRICK_BATCH_WIDTH == 4
+typedef __m128 BatchFloat;
+#define batch_load _mm_loadu_ps
+#define batch_store _mm_storeu_ps
+#define batch_set1 _mm_set1_ps
+#define batch_add _mm_add_ps
+#define batch_sub _mm_sub_ps
+#define batch_div _mm_div_ps
+#define batch_min _mm_min_ps
+#define batch_max _mm_max_ps
+#define batch_and _mm_and_ps
+#define batch_or _mm_or_ps
+#define batch_lt _mm_cmplt_ps
+#define batch_gt _mm_cmpgt_ps
+#define batch_select(mask, a, b) _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b))
+#endif
+
+// Runs swept_aabb of `b1` against bricks [first, first + count) of the field, writing each
+// brick's entry time and normal to the output arrays (which need room for count rounded up
+// to BRICK_BATCH_WIDTH). Every lane follows the same IEEE operations as the scalar version,
+// so the results match it exactly. Returns the smallest entry time of the `count` bricks.
+float swept_aabb_batch(SDL_FRect b1, SDL_FPoint vel, const BrickField* field, int first, int count, float* times, float* normals_x, float* normals_y) {
+    float min_time = INFINITY;
+    int lane = 0;
+
+#if BRICK_BATCH_WIDTH > 1
+    // Velocity is shared by every brick, so all the per-axis branches are taken once per batch
+    BatchFloat b1_left = batch_set1(b1.x);
+    BatchFloat b1_right = batch_set1(b1.x + b1.w);
+    BatchFloat b1_top = batch_set1(b1.y);
+    BatchFloat b1_bottom = batch_set1(b1.y + b1.h);
+    BatchFloat vel_x = batch_set1(vel.x);
+    BatchFloat vel_y = batch_set1(vel.y);
+    BatchFloat zero = batch_set1(0.0f);
+    BatchFloat one = batch_set1(1.0f);
+    BatchFloat normal_x_sign = batch_set1((vel.x > 0.0f) ? -1.0f : 1.0f);
+    BatchFloat normal_y_sign = batch_set1((vel.y > 0.0f) ? -1.0f : 1.0f);
+    BatchFloat lane_min = batch_set1(INFINITY);
+
+    for (; lane < count; lane += BRICK_BATCH_WIDTH) {
+        BatchFloat left = batch_load(field->x + first + lane);
+        BatchFloat top = batch_load(field->y + first + lane);
+        BatchFloat right = batch_add(left, batch_load(field->w + first + lane));
+        BatchFloat bottom = batch_add(top, batch_load(field->h + first + lane));
+        BatchFloat reject = batch_set1(0.0f);
+        BatchFloat entry_x, entry_y, exit_x, exit_y;
+
+        if (vel.x == 0.0f) {
+            reject = batch_or(batch_lt(b1_right, left), batch_gt(b1_left, right));
+            entry_x = batch_set1(-INFINITY);
+            exit_x = batch_set1(INFINITY);
+        } else if (vel.x > 0.0f) {
+            entry_x = batch_div(batch_sub(left, b1_right), vel_x);
+            exit_x = batch_div(batch_sub(right, b1_left), vel_x);
+        } else {
+            entry_x = batch_div(batch_sub(right, b1_left), vel_x);
+            exit_x = batch_div(batch_sub(left, b1_right), vel_x);
+        }
+
+        if (vel.y == 0.0f) {
+            reject = batch_or(reject, batch_or(batch_lt(b1_bottom, top), batch_gt(b1_top, bottom)));
+            entry_y = batch_set1(-INFINITY);
+            exit_y = batch_set1(INFINITY);
+        } else if (vel.y > 0.0f) {
+            entry_y = batch_div(batch_sub(top, b1_bottom), vel_y);
+            exit_y = batch_div(batch_sub(bottom, b1_top), vel_y);
+        } else {
+            entry_y = batch_div(batch_sub(bottom, b1_top), vel_y);
+            exit_y = batch_div(batch_sub(top, b1_bottom), vel_y);
+        }
+
+        BatchFloat entry_time = batch_max(entry_x, entry_y);
+        BatchFloat exit_time = batch_min(exit_x, exit_y);
+
+        reject = batch_or(reject, batch_gt(entry_time, exit_time));
+        reject = batch_or(reject, batch_and(batch_lt(entry_x, zero), batch_lt(entry_y, zero)));
+        reject = batch_or(reject, batch_or(batch_gt(entry_x, one), batch_gt(entry_y, one)));
+
+        BatchFloat x_axis = batch_gt(entry_x, entry_y);
+        BatchFloat t = batch_select(reject, one, entry_time);
+        BatchFloat nx = batch_select(reject, zero, batch_select(x_axis, normal_x_sign, zero));
+        BatchFloat ny = batch_select(reject, zero, batch_select(x_axis, zero, normal_y_sign));
+
+        batch_store(times + lane, t);
+        batch_store(normals_x + lane, nx);
+        batch_store(normals_y + lane, ny);
+
+        if (lane + BRICK_BATCH_WIDTH <= count) {
+            lane_min = batch_min(lane_min, t);
+        } else {
+            // Partial batch: lanes past `count` belong to other bricks and must not count
+            for (int i = lane; i < count; i++) {
+                if (times[i] < min_time) min_time = times[i];
+            }
+        }
+    }
+
+    float lanes[BRICK_BATCH_WIDTH];
+    batch_store(lanes, lane_min);
+    for (int i = 0; i < BRICK_BATCH_WIDTH; i++) {
+        if (lanes[i] < min_time) min_time = lanes[i];
+    }
+#else
+    for (; lane < count; lane++) {
+        times[lane] = swept_aabb(b1, vel, brick_rect(field, first + lane), &normals_x[lane], &normals_y[lane]);
+        if (times[lane] < min_time) min_time = times[lane];
+    }
+#endif
+
+    return min_time;
+}
+
+// Finds the inclusive row/column range of grid cells whose bricks can touch `box`.
+// The range is padded by BROADPHASE_MARGIN so it never drops a brick the full scan would hit.
+bool brick_grid_query(const BrickGrid* grid, SDL_FRect box, int* row_min, int* row_max, int* col_min, int* col_max) {
+    float min_x = box.x - BROADPHASE_MARGIN - grid->origin_x;
+    float max_x = box.x + box.w + BROADPHASE_MARGIN - grid->origin_x;
+    float min_y = box.y - BROADPHASE_MARGIN - grid->origin_y;
+    float max_y = box.y + box.h + BROADPHASE_MARGIN - grid->origin_y;
+
+    // Brick j spans [j * cell_w, j * cell_w + brick_w] relative to the origin
+    *col_min = (int)floorf((min_x - grid->brick_w) / grid->cell_w);
+    *col_max = (int)floorf(max_x / grid->cell_w);
+    *row_min = (int)floorf((min_y - grid->brick_h) / grid->cell_h);
+    *row_max = (int)floorf(max_y / grid->cell_h);
+
+    if (*col_min < 0) *col_min = 0;
+    if (*row_min < 0) *row_min = 0;
+    if (*col_max > grid->cols - 1) *col_max = grid->cols - 1;
+    if (*row_max > grid->rows - 1) *row_max = grid->rows - 1;
+
+    return *col_min <= *col_max && *row_min <= *row_max;
+}
+
+// sweep_bricks against `collidable` instead of the field's own set, so a chunk of balls
+// can sweep against its private view of the board
+static int sweep_bricks_in(const BrickField* bricks, const Uint64* collidable, const BrickGrid* grid, SDL_FRect box, SDL_FPoint vel, float* time, float* normal_x, float* normal_y, int* hit_bricks) {
+    int hits = 0;
+    SDL_FRect sweep = box;
+    float dx = vel.x * *time;
+    float dy = vel.y * *time;
+    if (dx < 0.0f) sweep.x += dx;
+    if (dy < 0.0f) sweep.y += dy;
+    sweep.w += fabsf(dx);
+    sweep.h += fabsf(dy);
+
+    int row_min, row_max, col_min, col_max;
+    if (!brick_grid_query(grid, sweep, &row_min, &row_max, &col_min, &col_max)) {
+        return 0;
+    }
+
+    float batch_times[MAX_BRICK_COLS + BRICK_FIELD_PADDING];
+    float batch_normals_x[MAX_BRICK_COLS + BRICK_FIELD_PADDING];
+    float batch_normals_y[MAX_BRICK_COLS + BRICK_FIELD_PADDING];
+    int span = col_max - col_min + 1;
+
+    for (int i = row_min; i <= row_max; i++) {
+        int first = i * grid->cols + col_min;
+        int end = first + span;
+        bool any = false;
+        for (int w = first >> 6; w <= (end - 1) >> 6 && !any; w++) {
+            any = bitset_word_in_range(collidable, w, first, end) != 0;
+        }
+        if (!any) continue; // nothing solid left in this part of the row
+
+        float batch_min_time = swept_aabb_batch(box, vel, bricks, first, span, batch_times, batch_normals_x, batch_normals_y);
+        if (batch_min_time > *time) continue;
+
+        // Only solid bricks count; visit them in index order so ties list the same way every run
+        for (int w = first >> 6; w <= (end - 1) >> 6; w++) {
+            Uint64 bits = bitset_word_in_range(collidable, w, first, end);
+            while (bits != 0) {
+                int index = w * 64 + bitset_ctz(bits);
+                int lane = index - first;
+                bits &= bits - 1;
+
+                float t = batch_times[lane];
+                if (t < *time) {
+                    *time = t;
+                    *normal_x = batch_normals_x[lane];
+                    *normal_y = batch_normals_y[lane];
+                    hits = 1;
+                    hit_bricks[0] = index;
+                } else if (t == *time && hits < MAX_SIMULTANEOUS_HITS) {
+                    *normal_x += batch_normals_x[lane];
+                    *normal_y += batch_normals_y[lane];
+                    hit_bricks[hits++] = index;
+                }
+            }
+        }
+    }
+    return hits;
+}
+
+// Brick collision for `box` moving at `vel`, limited to the grid cells covered by the swept box.
+// `time` comes in as the longest time to look ahead and goes out as the earliest hit, if any.
+// Returns how many bricks are hit at that time and sums their normals.
+int sweep_bricks(const BrickField* bricks, const BrickGrid* grid, SDL_FRect box, SDL_FPoint vel, float* time, float* normal_x, float* normal_y, int* hit_bricks) {
+    return sweep_bricks_in(bricks, bricks->collidable, grid, box, vel, time, normal_x, normal_y, hit_bricks);
+}
+
+void store_previous_state(GameState* gs) {
+    gs->prev_paddle_x = gs->paddle.x;
+    for (int i = 0; i < gs->ball_count; i++) {
+        gs->balls[i].prev_pos.x = gs->balls[i].rect.x;
+        gs->balls[i].prev_pos.y = gs->balls[i].rect.y;
+    }
+    for (int i = 0; i < MAX_POWERUPS; i++) {
+        gs->powerups[i].prev_y = gs->powerups[i].rect.y;
+    }
+}
+
+void sim_copy_render_state(GameState* dst, const GameState* src) {
+    const BrickField* from = &src->bricks;
+    BrickField* to = &dst->bricks;
+    int count = from->count;
+    if (to->layout_id != from->layout_id) {
+        memcpy(to->x, from->x, sizeof(float) * count);
+        memcpy(to->y, from->y, sizeof(float) * count);
+        memcpy(to->w, from->w, sizeof(float) * count);
+        memcpy(to->h, from->h, sizeof(float) * count);
+        memcpy(to->sprite_row, from->sprite_row, count);
+        memcpy(to->animation_frame, from->animation_frame, sizeof(int) * count);
+        to->count = count;
+        to->layout_id = from->layout_id;
+    } else {
+        // Only breaking bricks change frame; solid ones stay at 0 until they're hit
+        for (int w = 0; w < BITSET_WORDS(count); w++) {
+            for (Uint64 bits = from->animating[w]; bits != 0; bits &= bits - 1) {
+                int i = w * 64 + bitset_ctz(bits);
+                to->animation_frame[i] = from->animation_frame[i];
+            }
+        }
+    }
+    size_t words = sizeof(Uint64) * BITSET_WORDS(count);
+    memcpy(to->alive, from->alive, words);
+    memcpy(to->collidable, from->collidable, words);
+    memcpy(to->animating, from->animating, words);
+    to->live = from->live;
+    to->animating_count = from->animating_count;
+
+    dst->paddle = src->paddle;
+    dst->prev_paddle_x = src->prev_paddle_x;
+    dst->paddle_vel_x = src->paddle_vel_x;
+    dst->left_pressed = src->left_pressed;
+    dst->right_pressed = src->right_pressed;
+    dst->brick_grid = src->brick_grid;
+    dst->levels = src->levels;
+    dst->level = src->level;
+    memcpy(dst->powerups, src->powerups, sizeof(src->powerups));
+    memcpy(dst->balls, src->balls, sizeof(Ball) * src->ball_count);
+    dst->ball_count = src->ball_count;
+    dst->chaos = src->chaos;
+    dst->ball_launched = src->ball_launched;
+    dst->lives = src->lives;
+    dst->paddle_size_level = src->paddle_size_level;
+    dst->sticky_paddle_timer_ns = src->sticky_paddle_timer_ns;
+    dst->force_field_y_offset = src->force_field_y_offset;
+    dst->force_field_anim_timer = src->force_field_anim_timer;
+    dst->paused = src->paused;
+    dst->game_over = src->game_over;
+    dst->sim_time_ns = src->sim_time_ns;
+    dst->game_speed = src->game_speed;
+}
+
+// Breaks brick `index`, or chips it if it takes more hits
+static void hit_brick(GameState* gs, int index) {
+    // Debris scales with the brick, so enormous boards don't flood the pool
+    float area = (gs->bricks.w[index] * gs->bricks.h[index]) / (BRICK_WIDTH * BRICK_HEIGHT);
+    int debris = SDL_max((int)(BRICK_DEBRIS_PARTICLES * area), 2);
+    SDL_Color color = debris_colors[gs->bricks.sprite_row[index]];
+    if (gs->bricks.hits_left[index] > 1) {
+        // Tough bricks chip instead of breaking
+        gs->bricks.hits_left[index]--;
+        if (gs->particles != NULL) {
+            particles_burst(gs->particles, brick_rect(&gs->bricks, index), SDL_max(debris / 4, 1), 0.1f, 400.0f, color);
+        }
+        return;
+    }
+    gs->bricks.hits_left[index] = 0;
+    gs->bricks.animation_frame[index] = 1;
+    gs->bricks.animation_timer[index] = 0;
+    bitset_clear(gs->bricks.collidable, index);
+    bitset_set(gs->bricks.animating, index);
+    gs->bricks.animating_count++;
+    spawn_powerup(gs, gs->bricks.x[index] + (gs->bricks.w[index] / 2) - (POWERUP_SIZE / 2), gs->bricks.y[index] + (gs->bricks.h[index] / 2) - (POWERUP_SIZE / 2));
+    if (gs->particles != NULL) {
+        particles_burst(gs->particles, brick_rect(&gs->bricks, index), debris, 0.15f, 700.0f, color);
+    }
+}
+
+// Moves ball `k` through the step, bouncing off the bricks in `collidable`. Hits go straight
+// to the board when `chunk` is NULL and are recorded in `chunk` otherwise, leaving the board
+// untouched so chunks can run at the same time.
+static void move_ball(GameState* gs, int k, float delta_seconds, Uint64* collidable, BallChunk* chunk) {
+    Ball* ball = &gs->balls[k];
+    bool is_sticky_paddle_active = gs->sticky_paddle_timer_ns > 0;
+    if (ball->is_stuck) {
+        ball->rect.x = gs->paddle.x + ball->stuck_offset_x;
+        ball->rect.y = gs->paddle.y - BALL_SIZE;
+        return;
+    }
+
+    if (gs->ball_launched) {
+        float remaining_time = delta_seconds;
+        
+        while (remaining_time > 0.00001f) {
+            float min_collision_time = remaining_time;
+            float combined_normal_x = 0.0f, combined_normal_y = 0.0f;
+            int num_collisions = 0;
+
+            int colliding_bricks[MAX_SIMULTANEOUS_HITS];
+            int num_colliding_bricks = 0;
+            bool paddle_collided = false;
+
+            SDL_FPoint vel = {ball->vel_x, ball->vel_y};
+
+            num_colliding_bricks = sweep_bricks_in(&gs->bricks, collidable, &gs->brick_grid, ball->rect, vel, &min_collision_time, &combined_normal_x, &combined_normal_y, colliding_bricks);
+            num_collisions = num_colliding_bricks;
+
+            // Paddle collision
+            if (gs->sim_time_ns - ball->last_collision_time_ns > SDL_MS_TO_NS(PADDLE_COLLISION_COOLDOWN)) {
+                float nx, ny;
+                float t = swept_aabb(ball->rect, vel, gs->paddle, &nx, &ny);
+                if (t < min_collision_time) {
+                    min_collision_time = t;
+                    num_collisions = 1;
+                    paddle_collided = true;
+                    num_colliding_bricks = 0;
+                } else if (t == min_collision_time) {
+                    paddle_collided = true;
+                    num_collisions++;
+                }
+            }
+
+            // Wall collisions
+            for (int i = 0; i < SIM_WALL_COUNT; i++) {
+                float nx, ny;
+                float t = swept_aabb(ball->rect, vel, sim_walls[i], &nx, &ny);
+                if (t < min_collision_time) {
+                    min_collision_time = t;
+                    combined_normal_x = nx;
+                    combined_normal_y = ny;
+                    num_collisions = 1;
+                    paddle_collided = false;
+                    num_colliding_bricks = 0;
+                } else if (t == min_collision_time) {
+                    combined_normal_x += nx;
+                    combined_normal_y += ny;
+                    num_collisions++;
+                }
+            }
+
+            ball->rect.x += ball->vel_x * min_collision_time;
+            ball->rect.y += ball->vel_y * min_collision_time;
+            
+            if (num_collisions > 0) {
+                if (paddle_collided) {
+                    ball->last_collision_time_ns = gs->sim_time_ns;
+                    if (is_sticky_paddle_active) {
+                        ball->is_stuck = true;
+                        ball->stuck_offset_x = ball->rect.x - gs->paddle.x;
+                        ball->vel_x = 0;
+                        ball->vel_y = 0;
+                        break; 
+                    } else {
+                        launch_ball(ball, gs->paddle.x, gs->paddle.w);
+                    }
+                } else {
+                    for (int i = 0; i < num_colliding_bricks; i++) {
+                        int index = colliding_bricks[i];
+                        if (!bitset_test(collidable, index)) continue;
+                        if (chunk == NULL) {
+                            hit_brick(gs, index);
+                            continue;
+                        }
+
+                        // Recorded for the merge; the chunk stops seeing the brick once this hit breaks it
+                        if (chunk->hit_count < SIM_CHUNK_HITS) {
+                            chunk->hits[chunk->hit_count++] = (BallHit){ k, index };
+                            if (gs->bricks.hits_left[index] <= 1) bitset_clear(collidable, index);
+                        }
+                    }
+
+                    float magnitude = sqrtf(combined_normal_x * combined_normal_x + combined_normal_y * combined_normal_y);
+                    if (magnitude > 0.0f) {
+                        float normalized_x = combined_normal_x / magnitude;
+                        float normalized_y = combined_normal_y / magnitude;
+                        
+                        float dot_product = ball->vel_x * normalized_x + ball->vel_y * normalized_y;
+                        ball->vel_x -= 2 * dot_product * normalized_x;
+                        ball->vel_y -= 2 * dot_product * normalized_y;
+                    }
+                }
+            }
+            
+            remaining_time -= min_collision_time;
+        }
+    }
+}
+
+// Ball `k` dropped out: flags it for packing away and costs a life when it was the last one
+static void lose_ball(GameState* gs, int k) {
+    gs->balls[k].active = false;
+    if (--gs->ball_count == 0) {
+        gs->lives--;
+        if (gs->lives <= 0) {
+            gs->game_over = true;
+        } else {
+            reset_ball(gs);
+        }
+    }
+}
+
+static void move_ball_chunk(void* data, int worker_index) {
+    (void)worker_index;
+    BallChunk* chunk = data;
+    GameState* gs = chunk->gs;
+    Uint64 collidable[BITSET_WORDS(MAX_BRICKS)];
+    memcpy(collidable, gs->bricks.collidable, BITSET_WORDS(gs->bricks.count) * sizeof(Uint64));
+
+    chunk->hit_count = 0;
+    for (int k = chunk->first; k < chunk->first + chunk->count; k++) {
+        if (gs->balls[k].active) move_ball(gs, k, chunk->delta_seconds, collidable, chunk);
+    }
+}
+
+typedef struct {
+    ParticleSystem* particles;
+    float delta_ms;
+} ParticlesJob;
+
+static void update_particles_job(void* data, int worker_index) {
+    (void)worker_index;
+    ParticlesJob* job = data;
+    particles_update(job->particles, job->delta_ms);
+}
+
+// Moves many balls as fixed-size chunks, on gs->jobs when attached. Each chunk sees the board
+// as it was at the start of the step, less the bricks its own balls break, so two chunks can
+// hit the same brick; the merge applies hits in ball order and the first one wins. Particles
+// don't depend on the balls until the merge, so they update alongside.
+// Returns whether any ball dropped out.
+static bool move_balls_in_chunks(GameState* gs, float delta_seconds, float delta_ms) {
+    int chunk_count = (gs->ball_count + SIM_CHUNK_BALLS - 1) / SIM_CHUNK_BALLS;
+    for (int c = 0; c < chunk_count; c++) {
+        BallChunk* chunk = &gs->ball_chunks[c];
+        chunk->gs = gs;
+        chunk->first = c * SIM_CHUNK_BALLS;
+        chunk->count = SDL_min(SIM_CHUNK_BALLS, gs->ball_count - chunk->first);
+        chunk->delta_seconds = delta_seconds;
+        if (gs->jobs != NULL) {
+            job_pool_submit(gs->jobs, move_ball_chunk, chunk);
+        } else {
+            move_ball_chunk(chunk, 0);
+        }
+    }
+    if (gs->particles != NULL) {
+        ParticlesJob particles_job = { gs->particles, delta_ms };
+        if (gs->jobs != NULL) {
+            job_pool_submit(gs->jobs, update_particles_job, &particles_job);
+            job_pool_wait(gs->jobs);
+        } else {
+            update_particles_job(&particles_job, 0);
+        }
+    } else if (gs->jobs != NULL) {
+        job_pool_wait(gs->jobs);
+    }
+
+    bool balls_lost = false;
+    for (int c = 0; c < chunk_count; c++) {
+        const BallChunk* chunk = &gs->ball_chunks[c];
+        int h = 0;
+        for (int k = chunk->first; k < chunk->first + chunk->count; k++) {
+            for (; h < chunk->hit_count && chunk->hits[h].ball == k; h++) {
+                int index = chunk->hits[h].brick;
+                if (bitset_test(gs->bricks.collidable, index)) hit_brick(gs, index);
+            }
+            if (gs->balls[k].active && gs->balls[k].rect.y > SCREEN_HEIGHT) {
+                lose_ball(gs, k);
+                balls_lost = true;
+            }
+        }
+    }
+    return balls_lost;
+}
+
+// Advances the simulation by `delta_ns` of simulation time (already scaled by game_speed).
+void update_gameplay(GameState* gs, Uint64 delta_ns) {
+    if (gs->paused) return;
+
+    gs->sim_time_ns += delta_ns;
+    float delta_ms = delta_ns / 1000000.0f;
+    float delta_seconds = delta_ns / 1000000000.0f;
+
+    float target_vel_x = 0.0f;
+    if (gs->left_pressed && !gs->right_pressed) {
+        target_vel_x = -PADDLE_SPEED;
+    } else if (gs->right_pressed && !gs->left_pressed) {
+        target_vel_x = PADDLE_SPEED;
+    }
+
+    if (target_vel_x != 0) {
+        gs->paddle_vel_x += (target_vel_x - gs->paddle_vel_x) * PADDLE_ACCELERATION * delta_seconds;
+    } else {
+        gs->paddle_vel_x = 0;
+    }
+
+    gs->paddle.x += gs->paddle_vel_x * delta_seconds;
+
+    if (gs->paddle.x < BORDER_THICKNESS) {
+        gs->paddle.x = BORDER_THICKNESS;
+    }
+    if (gs->paddle.x > SCREEN_WIDTH - gs->paddle.w - BORDER_THICKNESS) {
+        gs->paddle.x = SCREEN_WIDTH - gs->paddle.w - BORDER_THICKNESS;
+    }
+
+    bool is_sticky_paddle_active = gs->sticky_paddle_timer_ns > 0;
+
+    // Balls that drop out are only flagged while they move and packed away after
+    int ball_total = gs->ball_count;
+    bool balls_lost = false;
+    bool particles_updated = false;
+    if (ball_total <= SIM_CHUNK_BALLS) {
+        for (int k = 0; k < ball_total; k++) {
+            if (!gs->balls[k].active) continue;
+            move_ball(gs, k, delta_seconds, gs->bricks.collidable, NULL);
+            if (gs->balls[k].rect.y > SCREEN_HEIGHT) {
+                lose_ball(gs, k);
+                balls_lost = true;
+            }
+        }
+    } else {
+        balls_lost = move_balls_in_chunks(gs, delta_seconds, delta_ms);
+        particles_updated = gs->particles != NULL;
+    }
+    if (balls_lost) {
+        // Stable, so the balls keep their order; reset_ball may have put a fresh ball 0 in
+        int kept = 0;
+        for (int k = 0; k < ball_total; k++) {
+            if (gs->balls[k].active) {
+                if (kept != k) gs->balls[kept] = gs->balls[k];
+                kept++;
+            }
+        }
+        gs->ball_count = kept;
+    }
+
+    if (gs->bricks.live == 0) {
+        gs->stats.boards_cleared++;
+        gs->stats.clear_time_total_ns += gs->sim_time_ns - gs->stats.board_start_ns;
+        gs->level++;
+        reset_game(gs);
+    }
+
+    if (!gs->ball_launched) {
+        gs->balls[0].rect.x = gs->paddle.x + (gs->paddle.w / 2) - (BALL_SIZE / 2);
+        gs->balls[0].rect.y = gs->paddle.y - BALL_SIZE;
+    }
+
+    // Update powerups
+    for (int i = 0; i < MAX_POWERUPS; i++) {
+        if (gs->powerups[i].active) {
+            gs->powerups[i].rect.y += POWERUP_SPEED * delta_seconds;
+            if (SDL_HasRectIntersectionFloat(&gs->powerups[i].rect, &gs->paddle)) {
+                gs->powerups[i].active = false;
+                if (gs->powerups[i].type == POWERUP_ADD_LIFE) {
+                    gs->lives++;
+                } else if (gs->powerups[i].type == POWERUP_REMOVE_LIFE) {
+                    gs->lives--;
+                } else if (gs->powerups[i].type == POWERUP_PADDLE_WIDER) {
+                    if (gs->paddle_size_level < 3) {
+                        gs->paddle_size_level++;
+                    }
+                } else if (gs->powerups[i].type == POWERUP_PADDLE_NARROWER) {
+                    if (gs->paddle_size_level > -3) {
+                        gs->paddle_size_level--;
+                    }
+                } else if (gs->powerups[i].type == POWERUP_STICKY_PADDLE) {
+                    gs->sticky_paddle_timer_ns = SDL_MS_TO_NS(15000);
+                } else if (gs->powerups[i].type == POWERUP_BALL_SPLIT) {
+                    // A free ball gains a mirror image; in chaos mode every free ball does
+                    int count = gs->ball_count;
+                    for (int l = 0; l < count; l++) {
+                        if (gs->balls[l].is_stuck) continue;
+                        Ball* ball = add_ball(gs);
+                        if (ball == NULL) break;
+                        *ball = gs->balls[l];
+                        ball->vel_x = -gs->balls[l].vel_x;
+                        if (!gs->chaos) break;
+                    }
+                }
+
+                float old_width = gs->paddle.w;
+                gs->paddle.w = PADDLE_WIDTH_INITIAL + gs->paddle_size_level * PADDLE_WIDTH_STEP;
+                gs->paddle.x -= (gs->paddle.w - old_width) / 2;
+
+            } else if (gs->powerups[i].rect.y > SCREEN_HEIGHT) {
+                gs->powerups[i].active = false;
+            }
+        }
+    }
+
+    // Update brick animations
+    BrickField* bricks = &gs->bricks;
+    int unvisited = bricks->animating_count; // stop at the last animating brick, not the end of the board
+    for (int w = 0; unvisited > 0; w++) {
+        Uint64 bits = bricks->animating[w];
+        while (bits != 0) {
+            int i = w * 64 + bitset_ctz(bits);
+            bits &= bits - 1;
+            unvisited--;
+
+            bricks->animation_timer[i] += delta_ms;
+            if (bricks->animation_timer[i] > BRICK_ANIMATION_SPEED) {
+                bricks->animation_frame[i]++;
+                bricks->animation_timer[i] -= BRICK_ANIMATION_SPEED;
+                if (bricks->animation_frame[i] > 10) {
+                    bitset_clear(bricks->animating, i);
+                    bitset_clear(bricks->alive, i);
+                    bricks->animating_count--;
+                    bricks->live--;
+                }
+            }
+        }
+    }
+    
+    if (gs->sticky_paddle_timer_ns > 0) {
+        if (delta_ns >= gs->sticky_paddle_timer_ns) {
+            gs->sticky_paddle_timer_ns = 0;
+        } else {
+            gs->sticky_paddle_timer_ns -= delta_ns;
+        }
+
+        if (gs->sticky_paddle_timer_ns == 0) {
+            for (int i = 0; i < gs->ball_count; i++) {
+                if (gs->balls[i].is_stuck) {
+                    launch_ball(&gs->balls[i], gs->paddle.x, gs->paddle.w);
+                }
+            }
+        }
+    }
+
+    // Update force field animation
+    if (is_sticky_paddle_active) {
+        gs->force_field_anim_timer += delta_ms;
+        gs->force_field_y_offset = sinf(gs->force_field_anim_timer / 200.0f) * 3.0f;
+
+        // Spawn particles
+        if (gs->particles != NULL) {
+            ParticleSystem* ps = gs->particles;
+            float left_x = gs->paddle.x - 13 + 12;
+            float right_x = gs->paddle.x + gs->paddle.w - 10 + 12;
+            SDL_Color color = {100 + particles_randf(ps) * 50, 150 + particles_randf(ps) * 50, 255, 255};
+            particles_spawn(ps,
+                left_x + particles_randf(ps) * (right_x - left_x),
+                gs->paddle.y - 5 + gs->force_field_y_offset,
+                0, -0.025f - particles_randf(ps) * 0.025f,
+                1000, color);
+        }
+    }
+
+    if (gs->particles != NULL) {
+        // Ball trails
+        SDL_Color trail_color = {255, 230, 180, 160};
+        for (int i = 0; i < gs->ball_count; i++) {
+            const Ball* ball = &gs->balls[i];
+            if (ball->is_stuck || !gs->ball_launched) continue;
+            particles_spawn(gs->particles,
+                ball->rect.x + ball->rect.w / 2 + (particles_randf(gs->particles) - 0.5f) * 6,
+                ball->rect.y + ball->rect.h / 2 + (particles_randf(gs->particles) - 0.5f) * 6,
+                0, 0, BALL_TRAIL_LIFETIME_MS, trail_color);
+        }
+
+        if (!particles_updated) particles_update(gs->particles, delta_ms);
+    }
+}
+
+Uint64 sim_wall_clock(void* userdata) {
+    (void)userdata;
+    return SDL_GetTicksNS();
+}
+
+void sim_clock_init(SimClock* clock, SimClockFn now_ns, void* userdata) {
+    clock->now_ns = now_ns;
+    clock->userdata = userdata;
+    clock->last_ns = now_ns(userdata);
+    clock->frame_ns = 0;
+    clock->accumulator_ns = 0;
+    clock->steps = 0;
+    clock->before_step = NULL;
+    clock->step_userdata = NULL;
+    clock->pending_count = 0;
+    clock->on_input = NULL;
+    clock->input_userdata = NULL;
+}
+
+// Applies the queued inputs that happened before `before_ns`
+static void apply_pending_inputs(GameState* gs, SimClock* clock, Uint64 before_ns) {
+    int applied = 0;
+    while (applied < clock->pending_count && clock->pending[applied].time_ns < before_ns) {
+        SimInput input = clock->pending[applied].input;
+        sim_apply_input(gs, input);
+        if (clock->on_input != NULL) {
+            clock->on_input(gs, clock->steps, input, clock->input_userdata);
+        }
+        applied++;
+    }
+    clock->pending_count -= applied;
+    memmove(clock->pending, clock->pending + applied, sizeof(TimedInput) * clock->pending_count);
+}
+
+void sim_clock_queue_input(GameState* gs, SimClock* clock, SimInput input, Uint64 time_ns) {
+    if (clock->pending_count == SIM_INPUT_QUEUE) {
+        apply_pending_inputs(gs, clock, SDL_MAX_UINT64);
+    }
+    clock->pending[clock->pending_count++] = (TimedInput){ input, time_ns };
+}
+
+// Reads the clock, feeds the elapsed time into the fixed-step accumulator and runs as many
+// SIM_STEP_NS steps as it covers. Returns the interpolation factor for rendering.
+float advance_gameplay(GameState* gs, SimClock* clock) {
+    Uint64 now = clock->now_ns(clock->userdata);
+    Uint64 frame_ns = now - clock->last_ns;
+    clock->last_ns = now;
+    if (frame_ns > MAX_FRAME_NS) {
+        frame_ns = MAX_FRAME_NS;
+    }
+    clock->frame_ns = frame_ns;
+
+    // No steps will run to carry them, so e.g. an unpause takes effect right away
+    if (gs->paused || gs->game_over) {
+        apply_pending_inputs(gs, clock, SDL_MAX_UINT64);
+    }
+
+    if (!gs->paused) {
+        clock->accumulator_ns += (Uint64)(frame_ns * (double)gs->game_speed);
+    }
+
+    while (clock->accumulator_ns >= SIM_STEP_NS && !gs->game_over) {
+        // The accumulator is how far simulated time trails `now`, so this step starts at
+        // now - accumulator in wall time. Inputs closer to its start than to the next one's go in first.
+        Uint64 behind_ns = (Uint64)(clock->accumulator_ns / (double)gs->game_speed);
+        Uint64 step_start_ns = now > behind_ns ? now - behind_ns : 0;
+        apply_pending_inputs(gs, clock, step_start_ns + (Uint64)(SIM_STEP_NS / 2 / (double)gs->game_speed));
+
+        if (clock->before_step != NULL) {
+            clock->before_step(gs, clock->steps, clock->step_userdata);
+        }
+        store_previous_state(gs);
+        update_gameplay(gs, SIM_STEP_NS);
+        clock->accumulator_ns -= SIM_STEP_NS;
+        clock->steps++;
+    }
+
+    if (gs->game_over) {
+        clock->accumulator_ns = 0;
+    }
+
+    return (float)clock->accumulator_ns / SIM_STEP_NS;
+}
+
+float sim_predict_paddle_x(const GameState* gs, const SimClock* clock, float alpha, Uint64 now_ns) {
+    float x = gs->prev_paddle_x + (gs->paddle.x - gs->prev_paddle_x) * alpha;
+    if (gs->paused || gs->game_over) return x;
+
+    bool left = gs->left_pressed;
+    bool right = gs->right_pressed;
+    for (int i = 0; i < clock->pending_count; i++) {
+        switch (clock->pending[i].input) {
+            case SIM_INPUT_LEFT_DOWN: left = true; break;
+            case SIM_INPUT_LEFT_UP: left = false; break;
+            case SIM_INPUT_RIGHT_DOWN: right = true; break;
+            case SIM_INPUT_RIGHT_UP: right = false; break;
+            case SIM_INPUT_PAUSE: return x;
+            default: break;
+        }
+    }
+
+    float target_vel_x = 0.0f;
+    if (left && !right) {
+        target_vel_x = -PADDLE_SPEED;
+    } else if (right && !left) {
+        target_vel_x = PADDLE_SPEED;
+    }
+    if (target_vel_x == 0.0f) return x;
+
+    // The interpolated state trails the clock's last reading by one step
+    Uint64 ahead_ns = (now_ns > clock->last_ns ? now_ns - clock->last_ns : 0) + SIM_STEP_NS;
+    float ahead_seconds = SDL_min(ahead_ns * gs->game_speed, MAX_FRAME_NS) / 1000000000.0f;
+    float vel_x = gs->paddle_vel_x + (target_vel_x - gs->paddle_vel_x) * SDL_min(PADDLE_ACCELERATION * ahead_seconds, 1.0f);
+    x += vel_x * ahead_seconds;
+
+    if (x < BORDER_THICKNESS) {
+        x = BORDER_THICKNESS;
+    }
+    if (x > SCREEN_WIDTH - gs->paddle.w - BORDER_THICKNESS) {
+        x = SCREEN_WIDTH - gs->paddle.w - BORDER_THICKNESS;
+    }
+    return x;
+}
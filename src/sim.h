@@ -0,0 +1,260 @@
+#ifndef BRICKED_UP_SIM_H
+#define BRICKED_UP_SIM_H
+
+// Game simulation: everything that advances the game without a window, renderer or font.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include "particles.h"
+#include "level_pack.h"
+#include "bitset.h"
+#include "job_pool.h"
+
+#define SCREEN_WIDTH 800
+#define SCREEN_HEIGHT 600
+#define PADDLE_WIDTH_INITIAL 80
+#define PADDLE_WIDTH_STEP 10
+#define PADDLE_HEIGHT 20
+#define BALL_SIZE 24
+#define BRICK_WIDTH 64 // full-size brick; boards too big for BOARD_WIDTH x BOARD_HEIGHT scale down
+#define BRICK_HEIGHT 32
+#define BRICK_SPACING 11
+#define BOARD_WIDTH 739 // the classic 10 columns
+#define BOARD_HEIGHT 320
+#define MAX_BRICKS (MAX_BRICK_ROWS * MAX_BRICK_COLS)
+#define MAX_SIMULTANEOUS_HITS 64 // bricks one ball can hit at the same instant
+#define BRICK_FIELD_PADDING 8 // lets a batch read a full vector past the last brick
+#define BROADPHASE_MARGIN 1.0f
+#define TOP_MARGIN 70
+#define BORDER_THICKNESS 3
+#define POWERUP_SIZE 15
+#define MAX_POWERUPS 10
+#define POWERUP_SPAWN_COOLDOWN 250 // 0.25 seconds
+#define PADDLE_COLLISION_COOLDOWN 200 // 0.2 seconds
+#define BALL_LIMIT 5 // balls in play at once, outside chaos mode
+#define MAX_BALLS 4096 // size of the ball pool, all of which chaos mode can fill
+#define CHAOS_SERVE_BALLS 32 // balls fanned out by a serve in chaos mode
+#define SIM_CHUNK_BALLS 128 // balls per job when they move in chunks; fixed, so results never depend on the thread count
+#define SIM_CHUNK_HITS 512 // brick hits one chunk can report per step; later ones bounce the ball but leave the brick
+#define PADDLE_SPEED 500.0f
+#define PADDLE_ACCELERATION 10.0f
+#define BALL_SPEED 350.0f
+#define POWERUP_SPEED 100.0f
+#define BRICK_ANIMATION_SPEED 50 // ms per frame
+#define BRICK_DEBRIS_PARTICLES 48 // per brick hit
+#define BALL_TRAIL_LIFETIME_MS 250.0f
+#define SIM_STEP_NS (SDL_NS_PER_SECOND / 120) // fixed simulation step, 120 Hz
+#define MAX_FRAME_NS (SDL_NS_PER_SECOND / 4) // clamp long stalls instead of replaying them
+#define SIM_INPUT_QUEUE 64 // timestamped inputs waiting for their step
+#define SIM_WALL_COUNT 3
+
+typedef enum {
+    POWERUP_ADD_LIFE,
+    POWERUP_REMOVE_LIFE,
+    POWERUP_PADDLE_WIDER,
+    POWERUP_PADDLE_NARROWER,
+    POWERUP_BALL_SPLIT,
+    POWERUP_STICKY_PADDLE,
+    POWERUP_TYPE_COUNT
+} PowerUpType;
+
+typedef struct {
+    SDL_FRect rect;
+    bool active;
+    PowerUpType type;
+    float prev_y;
+} PowerUp;
+
+typedef struct {
+    SDL_FRect rect;
+    float vel_x;
+    float vel_y;
+    bool active; // only false between the ball dropping out and the end of the step
+    Uint64 last_collision_time_ns; // simulation time
+    bool is_stuck;
+    float stuck_offset_x;
+    SDL_FPoint prev_pos; // position at the start of the current step, for render interpolation
+} Ball;
+
+// Structure-of-arrays brick storage so the collision kernel can load a row of
+// bricks straight into vector registers. Brick (row, col) is at row * cols + col, and the
+// arrays are sized for the largest board so a GameState never allocates.
+//
+// Which bricks exist is kept in bitsets rather than per-brick flags, so loops visit only
+// the bricks in a given state and a mostly cleared board costs little more than an empty one.
+// A live brick is either collidable (solid) or animating (hit, breaking); bits past
+// `count` are always clear.
+typedef struct {
+    int count; // rows * cols of the current board; entries past it are unused
+    int layout_id; // renewed whenever the bricks change other than by play moving forward (a new board, a rewind), so copies know to take everything; never hashed
+    int live; // bricks still alive; the board is cleared when it reaches 0
+    int animating_count;
+    float x[MAX_BRICKS + BRICK_FIELD_PADDING];
+    float y[MAX_BRICKS + BRICK_FIELD_PADDING];
+    float w[MAX_BRICKS + BRICK_FIELD_PADDING];
+    float h[MAX_BRICKS + BRICK_FIELD_PADDING];
+    Uint64 alive[BITSET_WORDS(MAX_BRICKS)];
+    Uint64 collidable[BITSET_WORDS(MAX_BRICKS)];
+    Uint64 animating[BITSET_WORDS(MAX_BRICKS)];
+    int animation_frame[MAX_BRICKS]; // 0 = solid, 1-10 = animation
+    float animation_timer[MAX_BRICKS];
+    Uint8 sprite_row[MAX_BRICKS];
+    Uint8 hits_left[MAX_BRICKS];
+} BrickField;
+
+// Bricks sit on a regular lattice, so the lattice itself is the broadphase grid:
+// cell (i, j) holds brick i * cols + j at origin + (j * cell_w, i * cell_h).
+typedef struct {
+    int rows;
+    int cols;
+    float origin_x;
+    float origin_y;
+    float cell_w;
+    float cell_h;
+    float brick_w;
+    float brick_h;
+} BrickGrid;
+
+typedef struct {
+    int ball;
+    int brick;
+} BallHit;
+
+// Scratch for one chunk of balls moving in parallel: the bricks its balls hit this step,
+// in ball order, for the merge that applies them.
+typedef struct {
+    struct GameState* gs;
+    int first;
+    int count;
+    float delta_seconds;
+    int hit_count;
+    BallHit hits[SIM_CHUNK_HITS];
+} BallChunk;
+
+// Running totals for batch statistics; the game itself never reads them.
+typedef struct {
+    int boards_cleared;
+    Uint64 board_start_ns; // simulation time the current board was laid out
+    Uint64 clear_time_total_ns; // summed time taken by every cleared board
+} GameStats;
+
+typedef struct GameState {
+    SDL_FRect paddle;
+    float prev_paddle_x;
+    BrickField bricks;
+    BrickGrid brick_grid;
+    const LevelPack* levels; // boards are laid out from here, so the pack must outlive the game
+    int level; // boards cleared this game; wraps around the pack
+    PowerUp powerups[MAX_POWERUPS];
+    Ball balls[MAX_BALLS]; // the balls in play are packed at the front, oldest first
+    int ball_count;
+    bool chaos; // set after sim_start_game: no BALL_LIMIT, and serves and splits multiply balls
+    bool ball_launched;
+    bool left_pressed;
+    bool right_pressed;
+    int lives;
+    int paddle_size_level;
+    Uint64 last_powerup_spawn_time_ns;
+    Uint64 sticky_paddle_timer_ns;
+    ParticleSystem* particles; // optional and cosmetic, never hashed; attach after sim_start_game
+    JobPool* jobs; // optional, never hashed; attach after sim_start_game to move chunks of balls in parallel
+    BallChunk ball_chunks[MAX_BALLS / SIM_CHUNK_BALLS]; // scratch, only meaningful during a step
+    float force_field_y_offset;
+    float force_field_anim_timer;
+    bool paused;
+    bool game_over;
+    Uint64 sim_time_ns;
+    Uint64 rng_state; // per-game generator, so concurrent games never share random state
+    GameStats stats;
+    float game_speed;
+    float paddle_vel_x;
+} GameState;
+
+// Player inputs that change the game. Everything that reaches GameState from the
+// keyboard goes through sim_apply_input, so a recorded stream of them replays exactly.
+typedef enum {
+    SIM_INPUT_LEFT_DOWN,
+    SIM_INPUT_LEFT_UP,
+    SIM_INPUT_RIGHT_DOWN,
+    SIM_INPUT_RIGHT_UP,
+    SIM_INPUT_LAUNCH,
+    SIM_INPUT_PAUSE,
+    SIM_INPUT_COUNT
+} SimInput;
+
+// An input and when it happened, on the same clock as SimClock's now_ns.
+typedef struct {
+    SimInput input;
+    Uint64 time_ns;
+} TimedInput;
+
+// Called by advance_gameplay before each fixed step; `step` is the index of the step about to run.
+typedef void (*SimStepFn)(GameState* gs, Uint64 step, void* userdata);
+
+// Called when advance_gameplay applies a queued input, just before step `step`.
+typedef void (*SimInputFn)(GameState* gs, Uint64 step, SimInput input, void* userdata);
+
+// Source of "now" for advance_gameplay. The game reads SDL_GetTicksNS; headless
+// drivers inject a virtual clock so they can run faster than real time.
+typedef Uint64 (*SimClockFn)(void* userdata);
+
+typedef struct {
+    SimClockFn now_ns;
+    void* userdata;
+    Uint64 last_ns;
+    Uint64 frame_ns; // wall time covered by the most recent advance_gameplay call
+    Uint64 accumulator_ns;
+    Uint64 steps; // total fixed steps run through this clock
+    SimStepFn before_step; // optional, e.g. replay recording or playback
+    void* step_userdata;
+    TimedInput pending[SIM_INPUT_QUEUE]; // oldest first
+    int pending_count;
+    SimInputFn on_input; // optional, e.g. replay recording
+    void* input_userdata;
+} SimClock;
+
+void sim_seed(GameState* gs, Uint64 seed);
+Uint32 sim_rand(GameState* gs);
+float sim_randf(GameState* gs);
+void sim_start_game(GameState* gs, Uint64 seed, const LevelPack* levels);
+void sim_apply_input(GameState* gs, SimInput input);
+Uint64 sim_hash(const GameState* gs);
+SDL_FRect brick_rect(const BrickField* field, int index);
+void brick_remove(BrickField* field, int index);
+void launch_ball(Ball* ball, float paddle_x, float paddle_w);
+void launch_pressed(GameState* gs);
+void initialize_powerups(GameState* gs);
+void spawn_powerup(GameState* gs, float x, float y);
+void reset_ball(GameState* gs);
+void reset_game(GameState* gs);
+void lay_out_board(GameState* gs);
+int new_layout_id(void);
+// Top, left and right; balls leave through the open bottom.
+extern const SDL_FRect sim_walls[SIM_WALL_COUNT];
+
+float swept_aabb(SDL_FRect b1, SDL_FPoint vel, SDL_FRect b2, float* normal_x, float* normal_y);
+float swept_aabb_batch(SDL_FRect b1, SDL_FPoint vel, const BrickField* field, int first, int count, float* times, float* normals_x, float* normals_y);
+bool brick_grid_query(const BrickGrid* grid, SDL_FRect box, int* row_min, int* row_max, int* col_min, int* col_max);
+// `hit_bricks` needs room for MAX_SIMULTANEOUS_HITS; ties past that are ignored.
+int sweep_bricks(const BrickField* bricks, const BrickGrid* grid, SDL_FRect box, SDL_FPoint vel, float* time, float* normal_x, float* normal_y, int* hit_bricks);
+void store_previous_state(GameState* gs);
+
+// Copies everything drawing reads from `src` into `dst`, so a renderer can draw `dst` on
+// another thread. Brick geometry is only copied when `dst` holds a different board, and
+// dst->particles and dst->jobs are left alone.
+void sim_copy_render_state(GameState* dst, const GameState* src);
+void update_gameplay(GameState* gs, Uint64 delta_ns);
+
+Uint64 sim_wall_clock(void* userdata);
+void sim_clock_init(SimClock* clock, SimClockFn now_ns, void* userdata);
+float advance_gameplay(GameState* gs, SimClock* clock);
+
+// Queues `input` to be applied by advance_gameplay before the step nearest to `time_ns`,
+// rather than at the start of whichever frame notices it.
+void sim_clock_queue_input(GameState* gs, SimClock* clock, SimInput input, Uint64 time_ns);
+
+// Where the paddle will be at `now_ns`, extrapolated from the frame's interpolated state
+// with the queued inputs taken into account. For drawing only; the simulation is untouched.
+float sim_predict_paddle_x(const GameState* gs, const SimClock* clock, float alpha, Uint64 now_ns);
+
+#endif
@@ -0,0 +1,444 @@
+// Headless driver: plays games with a scripted paddle or the bot, without a window,
+// renderer or font, as fast as the CPU allows. Games are independent jobs on a
+// work-stealing pool, so a batch spreads over every core, and the run ends with aggregate
+// statistics.
+// It can also record one scripted game, or play a recorded replay back at full speed.
+#include "sim.h"
+#include "job_pool.h"
+#include "replay.h"
+#include "bot.h"
+#include "rewind.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    Uint64 now_ns;
+} VirtualClock;
+
+typedef struct {
+    float target_x;
+    Uint64 next_look_ns;
+    int looks;
+} Autopilot;
+
+// Where on the paddle to meet the ball, as a fraction of its width from the center.
+// Cycling through these keeps the ball from settling into a vertical loop.
+static const float autopilot_aims[] = { -0.3f, 0.1f, 0.35f, -0.15f, 0.0f, 0.25f, -0.4f };
+
+typedef struct {
+    int games;
+    Uint64 max_steps;
+    Uint64 frame_ns;
+    Uint64 reaction_ns;
+    Uint64 seed;
+    GameState** states; // one scratch game per pool worker
+    const char* record_path; // record game 0 here
+    const LevelPack* levels;
+    bool chaos;
+    bool bot; // steer with the predicting bot rather than the autopilot
+    JobPool* step_jobs; // set for a single game, which then spreads its balls over the pool
+} RunConfig;
+
+typedef struct {
+    const RunConfig* config;
+    int index;
+    bool game_over;
+    Uint64 steps;
+    Uint64 lifetime_ns;
+    int boards_cleared;
+    Uint64 clear_time_total_ns;
+    Uint64 bot_frames;
+    Uint64 bot_cells;
+    int bot_max_cells; // in one frame
+} GameJob;
+
+static Uint64 virtual_clock_now(void* userdata) {
+    return ((VirtualClock*)userdata)->now_ns;
+}
+
+static void pilot_input(GameState* gs, SimInput input, Replay* replay, Uint64 step) {
+    sim_apply_input(gs, input);
+    if (replay != NULL) {
+        replay_record_input(replay, step, input);
+    }
+}
+
+// Steers toward where the lowest ball was at its last look and serves whenever a ball is
+// waiting. It only re-reads the balls every `reaction_ns` of game time, so it can miss.
+static void autopilot(Autopilot* pilot, GameState* gs, Uint64 reaction_ns, Replay* replay, Uint64 step) {
+    float paddle_center = gs->paddle.x + gs->paddle.w / 2.0f;
+    bool holding = !gs->ball_launched;
+
+    if (gs->sim_time_ns >= pilot->next_look_ns) {
+        float lowest = -1.0f;
+        float aim = autopilot_aims[(pilot->looks++ / 8) % SDL_arraysize(autopilot_aims)] * gs->paddle.w;
+        pilot->target_x = paddle_center;
+        pilot->next_look_ns = gs->sim_time_ns + reaction_ns;
+        for (int i = 0; i < gs->ball_count; i++) {
+            if (gs->balls[i].rect.y > lowest) {
+                lowest = gs->balls[i].rect.y;
+                pilot->target_x = gs->balls[i].rect.x + gs->balls[i].rect.w / 2.0f - aim;
+            }
+        }
+    }
+
+    for (int i = 0; i < gs->ball_count; i++) {
+        if (gs->balls[i].is_stuck) holding = true;
+    }
+
+    bool left = pilot->target_x < paddle_center - gs->paddle.w / 4.0f;
+    bool right = pilot->target_x > paddle_center + gs->paddle.w / 4.0f;
+    if (left != gs->left_pressed) {
+        pilot_input(gs, left ? SIM_INPUT_LEFT_DOWN : SIM_INPUT_LEFT_UP, replay, step);
+    }
+    if (right != gs->right_pressed) {
+        pilot_input(gs, right ? SIM_INPUT_RIGHT_DOWN : SIM_INPUT_RIGHT_UP, replay, step);
+    }
+    if (holding) {
+        pilot_input(gs, SIM_INPUT_LAUNCH, replay, step);
+    }
+}
+
+static void play_game(void* data, int worker_index) {
+    GameJob* job = data;
+    const RunConfig* config = job->config;
+    GameState* gs = config->states[worker_index];
+    VirtualClock virtual_clock = { 0 };
+    Autopilot pilot = { 0 };
+    Bot bot;
+    SimClock clock;
+    Uint64 seed = config->seed ^ ((Uint64)job->index * 0x9E3779B97F4A7C15ull);
+    Replay* replay = NULL;
+
+    sim_start_game(gs, seed, config->levels);
+    gs->chaos = config->chaos;
+    gs->jobs = config->step_jobs;
+    sim_clock_init(&clock, virtual_clock_now, &virtual_clock);
+    if (job->index == 0 && config->record_path != NULL) {
+        replay = replay_create(config->record_path, seed, config->levels->content_hash, config->chaos ? REPLAY_FLAG_CHAOS : 0);
+        if (replay != NULL) {
+            clock.before_step = replay_before_step;
+            clock.step_userdata = replay;
+        }
+    }
+
+    bot_init(&bot);
+    while (!gs->game_over && clock.steps < config->max_steps) {
+        if (config->bot) {
+            SimInput inputs[BOT_MAX_INPUTS];
+            int count = bot_update(&bot, gs, inputs);
+            for (int i = 0; i < count; i++) {
+                pilot_input(gs, inputs[i], replay, clock.steps);
+            }
+            job->bot_frames++;
+            job->bot_cells += bot.cells;
+            job->bot_max_cells = SDL_max(job->bot_max_cells, bot.cells);
+        } else {
+            autopilot(&pilot, gs, config->reaction_ns, replay, clock.steps);
+        }
+        virtual_clock.now_ns += config->frame_ns;
+        advance_gameplay(gs, &clock);
+    }
+    replay_close(replay, gs, clock.steps);
+
+    job->game_over = gs->game_over;
+    job->steps = clock.steps;
+    job->lifetime_ns = gs->sim_time_ns;
+    job->boards_cleared = gs->stats.boards_cleared;
+    job->clear_time_total_ns = gs->stats.clear_time_total_ns;
+}
+
+// Plays a replay `repeat` times as fast as possible, checking every recorded hash.
+static int play_replay(const char* path, int repeat, const LevelPack* levels) {
+    GameState* gs = malloc(sizeof(GameState));
+    Uint64 total_steps = 0;
+    Uint64 elapsed_ns = 0;
+    bool matched = true;
+
+    for (int run = 0; run < repeat && matched; run++) {
+        Replay* replay = replay_open(path);
+        if (replay == NULL) {
+            free(gs);
+            return 1;
+        }
+        if (replay_levels_hash(replay) != levels->content_hash) {
+            printf("Replay %s was recorded on a different level pack\n", path);
+            replay_close(replay, gs, 0);
+            free(gs);
+            return 1;
+        }
+
+        Uint64 start_ns = SDL_GetTicksNS();
+        Uint64 step = 0;
+        sim_start_game(gs, replay_seed(replay), levels);
+        gs->chaos = (replay_flags(replay) & REPLAY_FLAG_CHAOS) != 0;
+        for (;;) {
+            replay_before_step(gs, step, replay);
+            if (replay_finished(replay) || gs->game_over) break;
+            store_previous_state(gs);
+            update_gameplay(gs, SIM_STEP_NS);
+            step++;
+        }
+        elapsed_ns += SDL_GetTicksNS() - start_ns;
+        total_steps += step;
+
+        if (replay_diverged(replay)) {
+            printf("replay diverged at step %llu\n", (unsigned long long)replay_divergence_step(replay));
+            matched = false;
+        } else if (!replay_finished(replay)) {
+            printf("replay diverged: game over at step %llu, before the end of the recording\n", (unsigned long long)step);
+            matched = false;
+        }
+        replay_close(replay, gs, step);
+    }
+    free(gs);
+
+    double elapsed_s = elapsed_ns / 1e9;
+    printf("replay:          %s (%s)\n", path, matched ? "matched" : "DIVERGED");
+    printf("runs:            %d\n", repeat);
+    printf("steps:           %llu\n", (unsigned long long)total_steps);
+    printf("wall time:       %.3f s\n", elapsed_s);
+    printf("steps/s:         %.0f\n", elapsed_s > 0.0 ? total_steps / elapsed_s : 0.0);
+    return matched ? 0 : 1;
+}
+
+#define REWIND_CHECK_BYTES (64 * 1024) // small, so the arena wraps over and over
+#define REWIND_CHECK_FRAMES 100000 // never the limit; the arena runs out first
+#define REWIND_CHECK_KEYFRAME_INTERVAL 4
+#define REWIND_CHECK_EVERY 8 // steps between restoring every held frame; the newest is restored every step
+
+// Plays one scripted game, capturing every step into a rewind buffer small enough to wrap
+// many times. The newest frame is restored after every capture and every held frame every
+// REWIND_CHECK_EVERY captures, each checked against the hash of the state it came from.
+static int check_rewind(const RunConfig* config) {
+    GameState* gs = malloc(sizeof(GameState));
+    GameState* restored = malloc(sizeof(GameState));
+    Uint64* hashes = malloc(sizeof(Uint64) * config->max_steps);
+    RewindBuffer* rewind = rewind_create(REWIND_CHECK_BYTES, REWIND_CHECK_FRAMES, REWIND_CHECK_KEYFRAME_INTERVAL);
+    if (gs == NULL || restored == NULL || hashes == NULL || rewind == NULL) {
+        printf("Failed to allocate the rewind check\n");
+        rewind_destroy(rewind);
+        free(hashes);
+        free(restored);
+        free(gs);
+        return 1;
+    }
+
+    Autopilot pilot = { 0 };
+    Uint64 restores = 0;
+    Uint64 too_big = 0;
+    Uint64 step = 0;
+    bool matched = true;
+    sim_start_game(gs, config->seed, config->levels);
+    gs->chaos = config->chaos;
+    memcpy(restored, gs, sizeof(GameState));
+    for (; step < config->max_steps && !gs->game_over && matched; step++) {
+        autopilot(&pilot, gs, config->reaction_ns, NULL, step);
+        store_previous_state(gs);
+        update_gameplay(gs, SIM_STEP_NS);
+        hashes[step] = sim_hash(gs);
+        if (!rewind_capture(rewind, gs)) {
+            too_big++;
+            continue;
+        }
+
+        // Held frame i was captured at step + 1 - count + i
+        int count = rewind_count(rewind);
+        int first = step % REWIND_CHECK_EVERY == 0 ? 0 : count - 1;
+        for (int frame = first; frame < count && matched; frame++) {
+            Uint64 captured = step + 1 - (Uint64)count + (Uint64)frame;
+            if (!rewind_restore(rewind, frame, restored) || sim_hash(restored) != hashes[captured]) {
+                printf("rewind check failed at step %llu: frame %d of %d (captured at step %llu) restored wrong\n",
+                    (unsigned long long)step, frame, count, (unsigned long long)captured);
+                matched = false;
+            }
+            restores++;
+        }
+    }
+
+    printf("rewind check:    %s\n", matched ? "every restore matched" : "FAILED");
+    printf("captures:        %llu (%llu too big for the buffer), %.0f KB arena\n", (unsigned long long)step,
+        (unsigned long long)too_big, REWIND_CHECK_BYTES / 1024.0);
+    printf("restores:        %llu\n", (unsigned long long)restores);
+    rewind_destroy(rewind);
+    free(hashes);
+    free(restored);
+    free(gs);
+    return matched ? 0 : 1;
+}
+
+static void usage(const char* program) {
+    printf("Usage: %s [--games N] [--threads N] [--max-steps N] [--frame-ms MS] [--reaction-ms MS] [--seed N] [--record FILE] [--levels FILE] [--chaos] [--bot]\n", program);
+    printf("       %s --replay FILE [--repeat N] [--levels FILE]\n", program);
+    printf("       %s --check-rewind [--max-steps N] [--seed N] [--levels FILE] [--chaos]\n", program);
+    printf("  --games N        games to play (default 100)\n");
+    printf("  --threads N      worker threads, including this one (default: all cores)\n");
+    printf("  --max-steps N    cap on fixed steps per game (default 72000, 10 minutes)\n");
+    printf("  --frame-ms MS    virtual frame length fed to advance_gameplay (default 16.667)\n");
+    printf("  --reaction-ms MS how often the scripted paddle looks at the balls (default 100)\n");
+    printf("  --seed N         base seed; game i plays with a seed derived from it (default: time)\n");
+    printf("  --record FILE    record the inputs of game 0 as a replay\n");
+    printf("  --replay FILE    play a replay back at full speed and check it against the recording\n");
+    printf("  --repeat N       times to play the replay (default 1)\n");
+    printf("  --levels FILE    level pack to play (default: the built-in board)\n");
+    printf("  --chaos          chaos mode: serves fan out into %d balls and splits double them, up to %d\n", CHAOS_SERVE_BALLS, MAX_BALLS);
+    printf("  --check-rewind   play one game through a small rewind buffer, checking every restore\n");
+    printf("  --bot            play with the bot that traces the balls ahead, instead of the scripted paddle\n");
+}
+
+int main(int argc, char* argv[]) {
+    RunConfig config = { 0 };
+    int threads = SDL_GetNumLogicalCPUCores();
+    double frame_ms = 1000.0 / 60.0;
+    double reaction_ms = 100.0;
+    const char* replay_path = NULL;
+    const char* levels_path = NULL;
+    int repeat = 1;
+    bool rewind_check = false;
+
+    config.games = 100;
+    config.max_steps = 72000;
+    config.seed = (Uint64)time(NULL);
+    config.record_path = NULL;
+    config.chaos = false;
+    config.bot = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc) {
+            config.games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--max-steps") == 0 && i + 1 < argc) {
+            config.max_steps = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--frame-ms") == 0 && i + 1 < argc) {
+            frame_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--reaction-ms") == 0 && i + 1 < argc) {
+            reaction_ms = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            config.record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repeat = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--levels") == 0 && i + 1 < argc) {
+            levels_path = argv[++i];
+        } else if (strcmp(argv[i], "--chaos") == 0) {
+            config.chaos = true;
+        } else if (strcmp(argv[i], "--bot") == 0) {
+            config.bot = true;
+        } else if (strcmp(argv[i], "--check-rewind") == 0) {
+            rewind_check = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (config.games <= 0 || frame_ms <= 0.0 || reaction_ms < 0.0 || repeat <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+    LevelPack* pack = NULL;
+    if (levels_path != NULL) {
+        pack = level_pack_open(levels_path);
+        if (pack == NULL) return 1;
+    }
+    config.levels = pack != NULL ? pack : level_pack_builtin();
+    if (replay_path != NULL) {
+        int result = play_replay(replay_path, repeat, config.levels);
+        level_pack_close(pack);
+        return result;
+    }
+    if (threads < 1) threads = 1;
+    config.frame_ns = (Uint64)(frame_ms * 1000000.0);
+    config.reaction_ns = (Uint64)(reaction_ms * 1000000.0);
+    if (rewind_check) {
+        int result = check_rewind(&config);
+        level_pack_close(pack);
+        return result;
+    }
+
+    JobPool* pool = job_pool_create(threads - 1);
+    int workers = job_pool_worker_count(pool);
+    config.states = calloc(workers, sizeof(GameState*));
+    GameJob* jobs = calloc(config.games, sizeof(GameJob));
+    if (config.states == NULL || jobs == NULL) {
+        printf("Failed to allocate game states\n");
+        return 1;
+    }
+    for (int i = 0; i < workers; i++) {
+        config.states[i] = malloc(sizeof(GameState));
+        if (config.states[i] == NULL) {
+            printf("Failed to allocate game states\n");
+            return 1;
+        }
+    }
+
+    Uint64 start_ns = SDL_GetTicksNS();
+    if (config.games == 1) {
+        // Nothing to run alongside a lone game, so the pool works inside its steps instead
+        config.step_jobs = pool;
+        jobs[0].config = &config;
+        play_game(&jobs[0], 0);
+    } else {
+        for (int i = 0; i < config.games; i++) {
+            jobs[i].config = &config;
+            jobs[i].index = i;
+            job_pool_submit(pool, play_game, &jobs[i]);
+        }
+        job_pool_wait(pool);
+    }
+    Uint64 elapsed_ns = SDL_GetTicksNS() - start_ns;
+
+    Uint64 total_steps = 0;
+    Uint64 total_lifetime_ns = 0;
+    Uint64 total_clear_time_ns = 0;
+    int game_overs = 0;
+    int boards_cleared = 0;
+    Uint64 bot_frames = 0;
+    Uint64 bot_cells = 0;
+    int bot_max_cells = 0;
+    for (int i = 0; i < config.games; i++) {
+        total_steps += jobs[i].steps;
+        total_lifetime_ns += jobs[i].lifetime_ns;
+        total_clear_time_ns += jobs[i].clear_time_total_ns;
+        boards_cleared += jobs[i].boards_cleared;
+        if (jobs[i].game_over) game_overs++;
+        bot_frames += jobs[i].bot_frames;
+        bot_cells += jobs[i].bot_cells;
+        bot_max_cells = SDL_max(bot_max_cells, jobs[i].bot_max_cells);
+    }
+
+    double elapsed_s = elapsed_ns / 1e9;
+    double simulated_s = (double)total_steps * SIM_STEP_NS / 1e9;
+
+    printf("games:           %d (%d game over, %d hit the step cap)\n", config.games, game_overs, config.games - game_overs);
+    printf("threads:         %d\n", workers);
+    printf("wall time:       %.3f s\n", elapsed_s);
+    printf("games/s:         %.1f\n", elapsed_s > 0.0 ? config.games / elapsed_s : 0.0);
+    printf("steps/s:         %.0f\n", elapsed_s > 0.0 ? total_steps / elapsed_s : 0.0);
+    printf("realtime x:      %.1f\n", elapsed_s > 0.0 ? simulated_s / elapsed_s : 0.0);
+    printf("mean lifetime:   %.1f s\n", total_lifetime_ns / 1e9 / config.games);
+    printf("boards cleared:  %d\n", boards_cleared);
+    if (boards_cleared > 0) {
+        printf("mean clear time: %.1f s\n", total_clear_time_ns / 1e9 / boards_cleared);
+    } else {
+        printf("mean clear time: n/a\n");
+    }
+    if (config.bot) {
+        printf("bot grid cells:  %.1f a frame on average, %d at most (budget %d)\n",
+            bot_frames > 0 ? (double)bot_cells / bot_frames : 0.0, bot_max_cells, BOT_CELL_BUDGET);
+    }
+
+    job_pool_destroy(pool);
+    for (int i = 0; i < workers; i++) {
+        free(config.states[i]);
+    }
+    free(config.states);
+    free(jobs);
+    level_pack_close(pack);
+    return 0;
+}
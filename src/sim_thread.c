@@ -0,0 +1,215 @@
+#include "sim_thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNAPSHOT_FRESH 4 // set in `middle` when it holds a snapshot the reader hasn't taken
+
+struct SimThread {
+    SimSnapshot* snapshots[3];
+    // Triple buffer: the writer fills `back`, the reader draws `front`, and they trade
+    // through `middle` with atomic exchanges, so each always has a buffer to itself.
+    int back; // sim thread only
+    int front; // render thread only
+    SDL_AtomicInt middle;
+
+    SimCommand commands[SIM_COMMAND_QUEUE];
+    SDL_AtomicInt commands_posted; // written by the render thread
+    SDL_AtomicInt commands_taken; // written by the sim thread
+
+    SDL_Thread* thread;
+    SDL_AtomicInt stopping;
+    GameState* gs;
+    SimClock* clock;
+    Replay* playback;
+    RewindBuffer* rewind;
+    bool rewinding;
+    int rewind_frame; // the frame restored last while rewinding
+};
+
+SimThread* sim_thread_create(void) {
+    SimThread* st = calloc(1, sizeof(SimThread));
+    if (st == NULL) return NULL;
+    for (int i = 0; i < 3; i++) {
+        st->snapshots[i] = calloc(1, sizeof(SimSnapshot));
+        if (st->snapshots[i] == NULL) {
+            sim_thread_destroy(st);
+            return NULL;
+        }
+        st->snapshots[i]->particles = particles_create(PARTICLE_CAPACITY);
+        if (st->snapshots[i]->particles == NULL) {
+            sim_thread_destroy(st);
+            return NULL;
+        }
+    }
+    st->front = 0;
+    SDL_SetAtomicInt(&st->middle, 1);
+    st->back = 2;
+    return st;
+}
+
+void sim_thread_destroy(SimThread* st) {
+    if (st == NULL) return;
+    sim_thread_stop(st);
+    for (int i = 0; i < 3; i++) {
+        if (st->snapshots[i] != NULL) particles_destroy(st->snapshots[i]->particles);
+        free(st->snapshots[i]);
+    }
+    free(st);
+}
+
+static void publish(SimThread* st, bool ended) {
+    SimSnapshot* snapshot = st->snapshots[st->back];
+    sim_copy_render_state(&snapshot->gs, st->gs);
+    snapshot->gs.particles = NULL;
+    snapshot->particles->count = 0;
+    if (st->gs->particles != NULL) {
+        particles_copy(snapshot->particles, st->gs->particles);
+        snapshot->gs.particles = snapshot->particles;
+    }
+    snapshot->clock = *st->clock;
+    snapshot->commands_taken = (Uint32)SDL_GetAtomicInt(&st->commands_taken);
+    snapshot->ended = ended;
+    st->back = SDL_SetAtomicInt(&st->middle, st->back | SNAPSHOT_FRESH) & 3;
+}
+
+static void take_commands(SimThread* st) {
+    Uint32 taken = (Uint32)SDL_GetAtomicInt(&st->commands_taken);
+    Uint32 posted = (Uint32)SDL_GetAtomicInt(&st->commands_posted);
+    for (; taken != posted; taken++) {
+        const SimCommand* command = &st->commands[taken & (SIM_COMMAND_QUEUE - 1)];
+        if (command->type == SIM_COMMAND_INPUT) {
+            sim_clock_queue_input(st->gs, st->clock, command->input, command->time_ns);
+        } else if (command->type == SIM_COMMAND_SET_SPEED) {
+            st->gs->game_speed = command->speed;
+        } else if (command->type == SIM_COMMAND_REWIND && st->rewind != NULL && command->rewinding != st->rewinding) {
+            st->rewinding = command->rewinding;
+            if (st->rewinding) {
+                st->rewind_frame = rewind_count(st->rewind) - 1;
+            } else {
+                // Play goes on from the frame shown, so the ones after it are gone, and
+                // the time spent rewinding isn't caught up on
+                rewind_truncate(st->rewind, st->rewind_frame + 1);
+                st->clock->last_ns = st->clock->now_ns(st->clock->userdata);
+                st->clock->accumulator_ns = 0;
+            }
+        }
+    }
+    SDL_SetAtomicInt(&st->commands_taken, (int)taken);
+}
+
+static int sim_thread_main(void* data) {
+    SimThread* st = data;
+    GameState* gs = st->gs;
+    SimClock* clock = st->clock;
+
+    while (!SDL_GetAtomicInt(&st->stopping)) {
+        take_commands(st);
+        if (st->rewinding) {
+            // A frame back per step's worth of time, so rewinding runs at the speed it was played
+            if (st->rewind_frame > 0) {
+                bool paused = gs->paused;
+                rewind_restore(st->rewind, --st->rewind_frame, gs);
+                gs->paused = paused; // a paused game stays paused, to look at frame by frame
+            }
+            publish(st, false);
+            SDL_DelayNS(SIM_STEP_NS);
+            continue;
+        }
+
+        Uint64 steps_before = clock->steps;
+        advance_gameplay(gs, clock);
+        if (st->rewind != NULL && clock->steps != steps_before && !gs->paused) {
+            rewind_capture(st->rewind, gs);
+        }
+
+        bool ended = gs->game_over;
+        if (st->playback != NULL) {
+            // Steps stop at game over, so the end record at that step is read here
+            if (gs->game_over && !replay_finished(st->playback)) {
+                replay_before_step(gs, clock->steps, st->playback);
+            }
+            if (replay_finished(st->playback)) ended = true;
+        }
+        publish(st, ended);
+        if (ended) break;
+
+        // Sleep until the next step is due; inputs that arrive meanwhile keep their timestamps
+        Uint64 wait_ns = SIM_STEP_NS;
+        if (!gs->paused && gs->game_speed > 0.0f) {
+            wait_ns = (Uint64)((SIM_STEP_NS - clock->accumulator_ns) / (double)gs->game_speed);
+        }
+        SDL_DelayNS(SDL_min(wait_ns, SIM_STEP_NS));
+    }
+    return 0;
+}
+
+bool sim_thread_start(SimThread* st, GameState* gs, SimClock* clock, Replay* playback, RewindBuffer* rewind) {
+    sim_thread_stop(st);
+    st->gs = gs;
+    st->clock = clock;
+    st->playback = playback;
+    st->rewind = rewind;
+    st->rewinding = false;
+    if (rewind != NULL) {
+        rewind_clear(rewind);
+        rewind_capture(rewind, gs);
+    }
+    SDL_SetAtomicInt(&st->commands_taken, SDL_GetAtomicInt(&st->commands_posted));
+    SDL_SetAtomicInt(&st->stopping, 0);
+    publish(st, false);
+
+    st->thread = SDL_CreateThread(sim_thread_main, "simulation", st);
+    if (st->thread == NULL) {
+        printf("Failed to start simulation thread: %s\n", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+void sim_thread_stop(SimThread* st) {
+    if (st->thread == NULL) return;
+    SDL_SetAtomicInt(&st->stopping, 1);
+    SDL_WaitThread(st->thread, NULL);
+    st->thread = NULL;
+}
+
+void sim_thread_post(SimThread* st, SimCommand command) {
+    Uint32 posted = (Uint32)SDL_GetAtomicInt(&st->commands_posted);
+    if (posted - (Uint32)SDL_GetAtomicInt(&st->commands_taken) == SIM_COMMAND_QUEUE) return;
+    st->commands[posted & (SIM_COMMAND_QUEUE - 1)] = command;
+    SDL_SetAtomicInt(&st->commands_posted, (int)(posted + 1));
+}
+
+const SimSnapshot* sim_thread_latest(SimThread* st) {
+    if (SDL_GetAtomicInt(&st->middle) & SNAPSHOT_FRESH) {
+        st->front = SDL_SetAtomicInt(&st->middle, st->front) & 3;
+    }
+    return st->snapshots[st->front];
+}
+
+float sim_thread_alpha(const SimSnapshot* snapshot, Uint64 now_ns) {
+    const GameState* gs = &snapshot->gs;
+    double ahead_ns = snapshot->clock.accumulator_ns;
+    if (!gs->paused && !gs->game_over && now_ns > snapshot->clock.last_ns) {
+        ahead_ns += (now_ns - snapshot->clock.last_ns) * (double)gs->game_speed;
+    }
+    return (float)SDL_min(ahead_ns / SIM_STEP_NS, 1.0);
+}
+
+float sim_thread_predict_paddle_x(SimThread* st, const SimSnapshot* snapshot, float alpha, Uint64 now_ns) {
+    // The snapshot's queue plus whatever was posted after it. The render thread wrote those
+    // entries itself, but posting only waits for the live taken count, so only the newest
+    // SIM_COMMAND_QUEUE are sure to be in the ring; older slots may hold newer commands.
+    SimClock clock = snapshot->clock;
+    Uint32 posted = (Uint32)SDL_GetAtomicInt(&st->commands_posted);
+    Uint32 first = snapshot->commands_taken;
+    if (posted - first > SIM_COMMAND_QUEUE) first = posted - SIM_COMMAND_QUEUE;
+    for (Uint32 i = first; i != posted && clock.pending_count < SIM_INPUT_QUEUE; i++) {
+        const SimCommand* command = &st->commands[i & (SIM_COMMAND_QUEUE - 1)];
+        if (command->type == SIM_COMMAND_INPUT) {
+            clock.pending[clock.pending_count++] = (TimedInput){ command->input, command->time_ns };
+        }
+    }
+    return sim_predict_paddle_x(&snapshot->gs, &clock, alpha, now_ns);
+}
@@ -0,0 +1,65 @@
+#ifndef BRICKED_UP_SIM_THREAD_H
+#define BRICKED_UP_SIM_THREAD_H
+
+// Runs a game on its own thread, so a slow present or a compositor stall never holds up
+// the simulation. After each batch of steps the thread publishes a snapshot of everything
+// drawing needs through a lock-free triple buffer, and the render thread takes the newest
+// complete one. Inputs go the other way through a single-producer ring. Neither side ever
+// waits on the other.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+#include "sim.h"
+#include "replay.h"
+#include "rewind.h"
+
+#define SIM_COMMAND_QUEUE 256 // power of two
+
+typedef enum {
+    SIM_COMMAND_INPUT,
+    SIM_COMMAND_SET_SPEED,
+    SIM_COMMAND_REWIND,
+} SimCommandType;
+
+typedef struct {
+    SimCommandType type;
+    SimInput input; // SIM_COMMAND_INPUT
+    Uint64 time_ns; // SIM_COMMAND_INPUT, on the game clock
+    float speed; // SIM_COMMAND_SET_SPEED
+    bool rewinding; // SIM_COMMAND_REWIND: start or stop stepping back through the rewind buffer
+} SimCommand;
+
+// One published state. Read-only to the render thread.
+typedef struct {
+    GameState gs; // only what sim_copy_render_state fills in; gs.particles points at `particles`
+    ParticleSystem* particles;
+    SimClock clock; // as the snapshot was taken, for interpolation and paddle prediction
+    Uint32 commands_taken; // commands the game had taken from the ring by then
+    bool ended; // game over, or the replay being played ran out; the thread has stopped stepping
+} SimSnapshot;
+
+typedef struct SimThread SimThread;
+
+SimThread* sim_thread_create(void);
+void sim_thread_destroy(SimThread* st);
+
+// Publishes the current state, then steps `gs` on the thread. Until sim_thread_stop, the
+// thread owns `gs`, `clock`, `playback` (the replay being played, or NULL) and `rewind`
+// (cleared, then fed a frame per batch of steps; NULL turns rewinding off).
+bool sim_thread_start(SimThread* st, GameState* gs, SimClock* clock, Replay* playback, RewindBuffer* rewind);
+void sim_thread_stop(SimThread* st);
+
+// Called from the render thread only. Commands that don't fit are dropped.
+void sim_thread_post(SimThread* st, SimCommand command);
+
+// The newest complete snapshot; it stays untouched until the next call.
+const SimSnapshot* sim_thread_latest(SimThread* st);
+
+// How far `now_ns` sits between the snapshot's previous and current step.
+float sim_thread_alpha(const SimSnapshot* snapshot, Uint64 now_ns);
+
+// sim_predict_paddle_x for the snapshot, counting inputs posted since it was taken (up to
+// the newest SIM_COMMAND_QUEUE commands).
+float sim_thread_predict_paddle_x(SimThread* st, const SimSnapshot* snapshot, float alpha, Uint64 now_ns);
+
+#endif
@@ -0,0 +1,95 @@
+#include "sprite_batch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool grow(SpriteBatch* batch, int capacity) {
+    SDL_Vertex* vertices = realloc(batch->vertices, sizeof(SDL_Vertex) * 4 * capacity);
+    if (vertices == NULL) return false;
+    batch->vertices = vertices;
+
+    int* indices = realloc(batch->indices, sizeof(int) * 6 * capacity);
+    if (indices == NULL) return false;
+    batch->indices = indices;
+
+    for (int i = batch->capacity; i < capacity; i++) {
+        int* quad = &indices[i * 6];
+        quad[0] = i * 4;
+        quad[1] = i * 4 + 1;
+        quad[2] = i * 4 + 2;
+        quad[3] = i * 4;
+        quad[4] = i * 4 + 2;
+        quad[5] = i * 4 + 3;
+    }
+    batch->capacity = capacity;
+    return true;
+}
+
+bool sprite_batch_init(SpriteBatch* batch, SDL_Renderer* renderer, SDL_Texture* texture) {
+    memset(batch, 0, sizeof(SpriteBatch));
+    batch->renderer = renderer;
+    batch->texture = texture;
+    if (texture != NULL && !SDL_GetTextureSize(texture, &batch->texture_w, &batch->texture_h)) {
+        printf("Failed to query sprite texture: %s\n", SDL_GetError());
+        return false;
+    }
+    if (!grow(batch, SPRITE_BATCH_INITIAL_CAPACITY)) {
+        printf("Failed to allocate sprite batch\n");
+        return false;
+    }
+    return true;
+}
+
+void sprite_batch_destroy(SpriteBatch* batch) {
+    free(batch->vertices);
+    free(batch->indices);
+    memset(batch, 0, sizeof(SpriteBatch));
+}
+
+void sprite_batch_add(SpriteBatch* batch, const SDL_FRect* src, const SDL_FRect* dst, SDL_FlipMode flip) {
+    if (batch->count == batch->capacity && !grow(batch, batch->capacity * 2)) {
+        // Out of memory: draw what we have and start over rather than drop the sprite
+        sprite_batch_flush(batch);
+    }
+
+    float u0 = src->x / batch->texture_w;
+    float v0 = src->y / batch->texture_h;
+    float u1 = (src->x + src->w) / batch->texture_w;
+    float v1 = (src->y + src->h) / batch->texture_h;
+    if (flip == SDL_FLIP_HORIZONTAL) {
+        float u = u0;
+        u0 = u1;
+        u1 = u;
+    } else if (flip == SDL_FLIP_VERTICAL) {
+        float v = v0;
+        v0 = v1;
+        v1 = v;
+    }
+
+    SDL_FColor white = {1.0f, 1.0f, 1.0f, 1.0f};
+    SDL_Vertex* v = &batch->vertices[batch->count * 4];
+    v[0] = (SDL_Vertex){{dst->x, dst->y}, white, {u0, v0}};
+    v[1] = (SDL_Vertex){{dst->x + dst->w, dst->y}, white, {u1, v0}};
+    v[2] = (SDL_Vertex){{dst->x + dst->w, dst->y + dst->h}, white, {u1, v1}};
+    v[3] = (SDL_Vertex){{dst->x, dst->y + dst->h}, white, {u0, v1}};
+    batch->count++;
+}
+
+void sprite_batch_add_rect(SpriteBatch* batch, const SDL_FRect* dst, SDL_FColor color) {
+    if (batch->count == batch->capacity && !grow(batch, batch->capacity * 2)) {
+        sprite_batch_flush(batch);
+    }
+
+    SDL_Vertex* v = &batch->vertices[batch->count * 4];
+    v[0] = (SDL_Vertex){{dst->x, dst->y}, color, {0, 0}};
+    v[1] = (SDL_Vertex){{dst->x + dst->w, dst->y}, color, {0, 0}};
+    v[2] = (SDL_Vertex){{dst->x + dst->w, dst->y + dst->h}, color, {0, 0}};
+    v[3] = (SDL_Vertex){{dst->x, dst->y + dst->h}, color, {0, 0}};
+    batch->count++;
+}
+
+void sprite_batch_flush(SpriteBatch* batch) {
+    if (batch->count == 0) return;
+    SDL_RenderGeometry(batch->renderer, batch->texture, batch->vertices, batch->count * 4, batch->indices, batch->count * 6);
+    batch->count = 0;
+}
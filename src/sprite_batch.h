@@ -0,0 +1,34 @@
+#ifndef BRICKED_UP_SPRITE_BATCH_H
+#define BRICKED_UP_SPRITE_BATCH_H
+
+// Collects quads that sample one texture and submits them with a single SDL_RenderGeometry
+// call, so the number of draw calls doesn't grow with the number of sprites. A batch with
+// no texture draws flat coloured quads instead.
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#define SPRITE_BATCH_INITIAL_CAPACITY 128
+
+typedef struct {
+    SDL_Renderer* renderer;
+    SDL_Texture* texture;
+    float texture_w;
+    float texture_h;
+    SDL_Vertex* vertices; // four per sprite
+    int* indices; // six per sprite, written when the buffers grow
+    int count;
+    int capacity;
+} SpriteBatch;
+
+// `texture` may be NULL for a batch of sprite_batch_add_rect quads.
+bool sprite_batch_init(SpriteBatch* batch, SDL_Renderer* renderer, SDL_Texture* texture);
+void sprite_batch_destroy(SpriteBatch* batch);
+
+// Same arguments as SDL_RenderTexture / SDL_RenderTextureRotated without the rotation.
+void sprite_batch_add(SpriteBatch* batch, const SDL_FRect* src, const SDL_FRect* dst, SDL_FlipMode flip);
+// Like SDL_RenderFillRect, for batches without a texture.
+void sprite_batch_add_rect(SpriteBatch* batch, const SDL_FRect* dst, SDL_FColor color);
+void sprite_batch_flush(SpriteBatch* batch);
+
+#endif
@@ -0,0 +1,180 @@
+#include "text.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Packs every glyph into one white-on-transparent surface, row by row
+static SDL_Surface* build_atlas(TextCache* cache, TTF_Font* font) {
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* glyphs[TEXT_GLYPH_COUNT];
+    int x = 0, y = 0, row_h = 0;
+
+    for (int i = 0; i < TEXT_GLYPH_COUNT; i++) {
+        int advance = 0;
+        glyphs[i] = TTF_RenderGlyph_Blended(font, TEXT_FIRST_GLYPH + i, white);
+        TTF_GetGlyphMetrics(font, TEXT_FIRST_GLYPH + i, NULL, NULL, NULL, NULL, &advance);
+        cache->glyph_advance[i] = (float)advance;
+        if (glyphs[i] == NULL) {
+            cache->glyph_rects[i] = (SDL_FRect){0, 0, 0, 0};
+            continue;
+        }
+        // One pixel of padding keeps linear filtering from bleeding in the neighbours
+        if (x + glyphs[i]->w + 1 > TEXT_ATLAS_WIDTH) {
+            x = 0;
+            y += row_h + 1;
+            row_h = 0;
+        }
+        cache->glyph_rects[i] = (SDL_FRect){(float)x, (float)y, (float)glyphs[i]->w, (float)glyphs[i]->h};
+        x += glyphs[i]->w + 1;
+        if (glyphs[i]->h > row_h) row_h = glyphs[i]->h;
+    }
+
+    SDL_Surface* atlas = SDL_CreateSurface(TEXT_ATLAS_WIDTH, y + row_h, SDL_PIXELFORMAT_ARGB8888);
+    for (int i = 0; i < TEXT_GLYPH_COUNT; i++) {
+        if (glyphs[i] == NULL) continue;
+        if (atlas != NULL) {
+            SDL_Rect dst = {(int)cache->glyph_rects[i].x, (int)cache->glyph_rects[i].y, glyphs[i]->w, glyphs[i]->h};
+            SDL_SetSurfaceBlendMode(glyphs[i], SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(glyphs[i], NULL, atlas, &dst);
+        }
+        SDL_DestroySurface(glyphs[i]);
+    }
+    return atlas;
+}
+
+bool text_cache_prepare(TextCache* cache, TTF_Font* font) {
+    memset(cache, 0, sizeof(TextCache));
+    cache->font = font;
+    cache->line_height = (float)TTF_GetFontHeight(font);
+
+    cache->atlas_pixels = build_atlas(cache, font);
+    if (cache->atlas_pixels == NULL) {
+        printf("Failed to build glyph atlas: %s\n", SDL_GetError());
+        return false;
+    }
+    cache->atlas_w = (float)cache->atlas_pixels->w;
+    cache->atlas_h = (float)cache->atlas_pixels->h;
+
+    cache->vertices = malloc(sizeof(SDL_Vertex) * 4 * TEXT_BATCH_GLYPHS);
+    cache->indices = malloc(sizeof(int) * 6 * TEXT_BATCH_GLYPHS);
+    if (cache->vertices == NULL || cache->indices == NULL) {
+        printf("Failed to allocate text batch\n");
+        return false;
+    }
+    for (int i = 0; i < TEXT_BATCH_GLYPHS; i++) {
+        int* quad = &cache->indices[i * 6];
+        quad[0] = i * 4;
+        quad[1] = i * 4 + 1;
+        quad[2] = i * 4 + 2;
+        quad[3] = i * 4;
+        quad[4] = i * 4 + 2;
+        quad[5] = i * 4 + 3;
+    }
+    return true;
+}
+
+bool text_cache_upload(TextCache* cache, SDL_Renderer* renderer) {
+    cache->renderer = renderer;
+    cache->atlas = SDL_CreateTextureFromSurface(renderer, cache->atlas_pixels);
+    SDL_DestroySurface(cache->atlas_pixels);
+    cache->atlas_pixels = NULL;
+    if (cache->atlas == NULL) {
+        printf("Failed to upload glyph atlas: %s\n", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+bool text_cache_init(TextCache* cache, SDL_Renderer* renderer, TTF_Font* font) {
+    return text_cache_prepare(cache, font) && text_cache_upload(cache, renderer);
+}
+
+void text_cache_destroy(TextCache* cache) {
+    for (int i = 0; i < cache->static_count; i++) {
+        SDL_DestroyTexture(cache->statics[i].texture);
+    }
+    if (cache->atlas != NULL) SDL_DestroyTexture(cache->atlas);
+    if (cache->atlas_pixels != NULL) SDL_DestroySurface(cache->atlas_pixels);
+    free(cache->vertices);
+    free(cache->indices);
+    memset(cache, 0, sizeof(TextCache));
+}
+
+static int glyph_index(char c) {
+    int index = (unsigned char)c - TEXT_FIRST_GLYPH;
+    if (index < 0 || index >= TEXT_GLYPH_COUNT) index = '?' - TEXT_FIRST_GLYPH;
+    return index;
+}
+
+float text_width(const TextCache* cache, const char* text, float scale) {
+    float width = 0.0f;
+    for (const char* c = text; *c != '\0'; c++) {
+        width += cache->glyph_advance[glyph_index(*c)];
+    }
+    return width * scale;
+}
+
+float text_height(const TextCache* cache, float scale) {
+    return cache->line_height * scale;
+}
+
+float text_queue(TextCache* cache, const char* text, float x, float y, SDL_Color color, float scale) {
+    SDL_FColor fcolor = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+
+    for (const char* c = text; *c != '\0'; c++) {
+        int index = glyph_index(*c);
+        const SDL_FRect* src = &cache->glyph_rects[index];
+        if (src->w > 0.0f) {
+            if (cache->queued == TEXT_BATCH_GLYPHS) text_flush(cache);
+
+            SDL_Vertex* v = &cache->vertices[cache->queued * 4];
+            float u0 = src->x / cache->atlas_w;
+            float v0 = src->y / cache->atlas_h;
+            float u1 = (src->x + src->w) / cache->atlas_w;
+            float v1 = (src->y + src->h) / cache->atlas_h;
+            float w = src->w * scale;
+            float h = src->h * scale;
+            v[0] = (SDL_Vertex){{x, y}, fcolor, {u0, v0}};
+            v[1] = (SDL_Vertex){{x + w, y}, fcolor, {u1, v0}};
+            v[2] = (SDL_Vertex){{x + w, y + h}, fcolor, {u1, v1}};
+            v[3] = (SDL_Vertex){{x, y + h}, fcolor, {u0, v1}};
+            cache->queued++;
+        }
+        x += cache->glyph_advance[index] * scale;
+    }
+    return x;
+}
+
+void text_flush(TextCache* cache) {
+    if (cache->queued == 0) return;
+    SDL_RenderGeometry(cache->renderer, cache->atlas, cache->vertices, cache->queued * 4, cache->indices, cache->queued * 6);
+    cache->queued = 0;
+}
+
+const StaticText* text_static(TextCache* cache, const char* text, SDL_Color color, bool solid) {
+    for (int i = 0; i < cache->static_count; i++) {
+        StaticText* entry = &cache->statics[i];
+        if (entry->solid == solid && strcmp(entry->text, text) == 0 &&
+            entry->color.r == color.r && entry->color.g == color.g && entry->color.b == color.b && entry->color.a == color.a) {
+            return entry;
+        }
+    }
+
+    // Full cache: evict the oldest entry
+    if (cache->static_count == TEXT_MAX_STATIC) {
+        SDL_DestroyTexture(cache->statics[0].texture);
+        memmove(&cache->statics[0], &cache->statics[1], sizeof(StaticText) * (TEXT_MAX_STATIC - 1));
+        cache->static_count--;
+    }
+
+    StaticText* entry = &cache->statics[cache->static_count++];
+    SDL_Surface* surface = solid ? TTF_RenderText_Solid(cache->font, text, 0, color) : TTF_RenderText_Blended(cache->font, text, 0, color);
+    entry->text = text;
+    entry->color = color;
+    entry->solid = solid;
+    entry->texture = surface != NULL ? SDL_CreateTextureFromSurface(cache->renderer, surface) : NULL;
+    entry->w = surface != NULL ? (float)surface->w : 0.0f;
+    entry->h = surface != NULL ? (float)surface->h : 0.0f;
+    if (surface != NULL) SDL_DestroySurface(surface);
+    return entry;
+}
@@ -0,0 +1,65 @@
+#ifndef BRICKED_UP_TEXT_H
+#define BRICKED_UP_TEXT_H
+
+// Text without per-frame surfaces or textures. Printable ASCII is rasterized once into a
+// glyph atlas; queued strings become textured quads that go out in one SDL_RenderGeometry
+// call per flush. Fixed strings that want TTF's own shaping (the title and game over
+// screens) are rendered whole once and kept as textures.
+
+#include <SDL3/SDL.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <stdbool.h>
+
+#define TEXT_FIRST_GLYPH 32 // space
+#define TEXT_GLYPH_COUNT 95 // through '~'
+#define TEXT_ATLAS_WIDTH 512
+#define TEXT_BATCH_GLYPHS 512
+#define TEXT_MAX_STATIC 16
+
+typedef struct {
+    const char* text;
+    SDL_Color color;
+    bool solid; // TTF_RenderText_Solid instead of _Blended
+    SDL_Texture* texture;
+    float w;
+    float h;
+} StaticText;
+
+typedef struct {
+    SDL_Renderer* renderer;
+    SDL_Texture* atlas;
+    SDL_Surface* atlas_pixels; // between text_cache_prepare and text_cache_upload
+    SDL_FRect glyph_rects[TEXT_GLYPH_COUNT]; // in atlas pixels
+    float glyph_advance[TEXT_GLYPH_COUNT];
+    float atlas_w;
+    float atlas_h;
+    float line_height;
+    TTF_Font* font;
+    SDL_Vertex* vertices; // four per queued glyph
+    int* indices; // six per glyph, filled once
+    int queued;
+    StaticText statics[TEXT_MAX_STATIC];
+    int static_count;
+} TextCache;
+
+bool text_cache_init(TextCache* cache, SDL_Renderer* renderer, TTF_Font* font);
+
+// text_cache_init in two halves, so the glyphs can be rasterized off the render thread:
+// prepare only touches the font, and upload makes the atlas a texture on the renderer's thread.
+bool text_cache_prepare(TextCache* cache, TTF_Font* font);
+bool text_cache_upload(TextCache* cache, SDL_Renderer* renderer);
+void text_cache_destroy(TextCache* cache);
+
+float text_width(const TextCache* cache, const char* text, float scale);
+float text_height(const TextCache* cache, float scale);
+
+// Adds a string to the batch; returns the x just past it, so differently colored runs can
+// follow on. Nothing is drawn until text_flush (or the batch fills up).
+float text_queue(TextCache* cache, const char* text, float x, float y, SDL_Color color, float scale);
+void text_flush(TextCache* cache);
+
+// A fixed string rendered whole on first use and reused afterwards. `text` is compared by
+// content, so string literals and other long-lived strings are what belongs here.
+const StaticText* text_static(TextCache* cache, const char* text, SDL_Color color, bool solid);
+
+#endif